@@ -18,6 +18,8 @@ HEADERS += \
 FORMS += \
     mainwindow.ui
 
+include(../HeatmapCommon/HeatmapCommon.pri)
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
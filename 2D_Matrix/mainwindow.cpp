@@ -1,12 +1,14 @@
 #include "mainwindow.h"
 #include <QPainter>
-#include <QMessageBox>
 #include <random>
 
 // Constructor for MainWindow
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , rows(60), cols(360)   // Initialize grid size (60 rows × 360 columns)
+    , axesDirty(true)
+    , hoverRow(-1), hoverCol(-1)
+    , hoverInfo(nullptr)
 {
     // Random number generator for filling zValues
     /*std::random_device rd;
@@ -16,136 +18,219 @@ MainWindow::MainWindow(QWidget *parent)
     // Resize zValues to create a 2D matrix (rows × cols)
 
     int x = 0;
-    zValues.resize(rows);
+    zValues.resize(rows, cols);
 
     for (int i = 0; i < rows; ++i) {
-        zValues[i].resize(cols);
+        int *row = zValues.row(i);
         for (int j = 0; j < cols; ++j) {
             // Assign random integer (1–100) to each cell
-            zValues[i][j] =x++;  // dis(gen);
+            row[j] =x++;  // dis(gen);
             if(x > 100)
                 x = 0;
         }
     }
+
+    setMouseTracking(true);   // hover highlight without a button pressed
+    hoverInfo = new HoverOverlay(this);
+
+    picker.setGridSize(rows, cols);
+    picker.setRowsBottomUp(true);   // row 0 at the bottom, like the Y axis
+    rebuildGridLayer();
 }
 
 // Destructor
 MainWindow::~MainWindow(){}
 
+// --- Cell size (you can adjust scale) ---
+static const double cellWidth = 4;    // width of one cell in pixels
+static const double cellHeight = 4;   // height of one cell in pixels
 
-// Paint grid of squares
-void MainWindow::paintEvent(QPaintEvent *event)
+// Grid centred in the window
+QRectF MainWindow::gridRect() const
 {
-    Q_UNUSED(event);
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    int w = width();
-    int h = height();
+    double gridWidth = cols * cellWidth;
+    double gridHeight = rows * cellHeight;
 
-    // --- Define your logical grid size ---
-    int rowsToDraw = rows;   // 60
-    int colsToDraw = cols;   // 360
+    double offsetX = (width() - gridWidth) / 2.0;
+    double offsetY = (height() - gridHeight) / 2.0;
 
-    // --- Cell size (you can adjust scale) ---
-    double cellWidth = 4;    // width of one cell in pixels
-    double cellHeight = 4;   // height of one cell in pixels
+    return QRectF(offsetX, offsetY, gridWidth, gridHeight);
+}
 
-    double gridWidth = colsToDraw * cellWidth;
-    double gridHeight = rowsToDraw * cellHeight;
+// Window rect of a cell (picker knows the bottom-up row order)
+QRect MainWindow::cellRect(int i, int j) const
+{
+    return picker.cellToScreen(i, j).toAlignedRect().adjusted(-1, -1, 1, 1);
+}
 
-    // --- Center position ---
-    double offsetX = (w - gridWidth) / 2.0;
-    double offsetY = (h - gridHeight) / 2.0;
+bool MainWindow::cellAt(const QPointF &pos, int *i, int *j) const
+{
+    return picker.cellAt(pos, i, j);
+}
 
-    // --- Draw background ---
-    painter.fillRect(offsetX, offsetY, gridWidth, gridHeight, Qt::white);
+// Grid layer: colour every cell once into a cols × rows image (row 0 at the bottom)
+void MainWindow::rebuildGridLayer()
+{
+    gridLayer = QImage(cols, rows, QImage::Format_RGB32);
 
-    // --- Draw grid cells ---
-    for (int i = 0; i < rowsToDraw; ++i) {
-        for (int j = 0; j < colsToDraw; ++j) {
-            int displayRow = rowsToDraw - 1 - i; // invert Y (bottom-up)
-            QRectF rect(offsetX + j * cellWidth,
-                        offsetY + displayRow * cellHeight,
-                        cellWidth, cellHeight);
+    for (int i = 0; i < rows; ++i) {
+        const int *row = zValues.row(i);
+        QRgb *line = reinterpret_cast<QRgb *>(gridLayer.scanLine(rows - 1 - i)); // invert Y
 
-            int z = zValues[i][j];
-            double intensity = z / 100.0;
+        for (int j = 0; j < cols; ++j) {
+            int z = row[j];
+            int intensity = qBound(0, z * 255 / 100, 255);
 
-            QColor color;
             if (z < 40)
-                color = QColor::fromRgbF(0.0, intensity, 0.0);
+                line[j] = qRgb(0, intensity, 0);
             else if (z < 70)
-                color = QColor::fromRgbF(intensity, intensity, 0.0);
+                line[j] = qRgb(intensity, intensity, 0);
             else
-                color = QColor::fromRgbF(intensity, 0.0, 0.0);
-
-            painter.setBrush(color);
-            painter.setPen(Qt::NoPen);
-            painter.drawRect(rect);
+                line[j] = qRgb(intensity, 0, 0);
         }
     }
 
+    update();
+}
+
+// Axes layer: transparent window-sized pixmap with axes, tick labels and titles
+void MainWindow::rebuildAxesLayer()
+{
+    qreal dpr = devicePixelRatioF();
+    axesLayer = QPixmap(size() * dpr);
+    axesLayer.setDevicePixelRatio(dpr);
+    axesLayer.fill(Qt::transparent);
+
+    QPainter painter(&axesLayer);
+
+    QRectF grid = gridRect();
+    double offsetX = grid.left();
+    double offsetY = grid.top();
+    double gridWidth = grid.width();
+    double gridHeight = grid.height();
+
     // --- Draw coordinate axes ---
     painter.setPen(QPen(Qt::black, 2));
 
     // X-axis (bottom)
-    painter.drawLine(offsetX, offsetY + gridHeight, offsetX + gridWidth, offsetY + gridHeight);
+    painter.drawLine(QPointF(offsetX, offsetY + gridHeight), QPointF(offsetX + gridWidth, offsetY + gridHeight));
     // Y-axis (left)
-    painter.drawLine(offsetX, offsetY, offsetX, offsetY + gridHeight);
+    painter.drawLine(QPointF(offsetX, offsetY), QPointF(offsetX, offsetY + gridHeight));
 
     // --- Axis labels ---
     painter.setPen(Qt::black);
     painter.setFont(QFont("Arial", 8));
 
     int xStep = 60;
-    for (int x = 0; x <= colsToDraw; x += xStep) {
+    for (int x = 0; x <= cols; x += xStep) {
         double px = offsetX + x * cellWidth;
-        painter.drawText(px - 10, offsetY + gridHeight + 15, QString::number(x));
+        painter.drawText(QPointF(px - 10, offsetY + gridHeight + 15), QString::number(x));
     }
 
     int yStep = 10;
-    for (int y = 0; y <= rowsToDraw; y += yStep) {
+    for (int y = 0; y <= rows; y += yStep) {
         double py = offsetY + gridHeight - y * cellHeight;
-        painter.drawText(offsetX - 25, py + 3, QString::number(y));
+        painter.drawText(QPointF(offsetX - 25, py + 3), QString::number(y));
     }
 
     // --- Axis titles ---
     painter.setFont(QFont("Arial", 10, QFont::Bold));
-    painter.drawText(offsetX + gridWidth + 10, offsetY + gridHeight + 10, "X");
-    painter.drawText(offsetX - 15, offsetY - 10, "Y");
+    painter.drawText(QPointF(offsetX + gridWidth + 10, offsetY + gridHeight + 10), "X");
+    painter.drawText(QPointF(offsetX - 15, offsetY - 10), "Y");
+
+    axesDirty = false;
 }
 
-// Handle mouse clicks (detect which cell was clicked)
-void MainWindow::mousePressEvent(QMouseEvent *event)
+// Paint: composite the cached layers, limited to the dirty rectangle
+void MainWindow::paintEvent(QPaintEvent *event)
 {
-    int w = width();
-    int h = height();
+    if (axesDirty)
+        rebuildAxesLayer();
 
-    double cellWidth = 4;
-    double cellHeight = 4;
+    QPainter painter(this);
+    QRect dirty = event->rect();
+
+    // --- Grid layer: only the part of the image under the dirty rect ---
+    QRectF grid = gridRect();
+    QRectF target = grid.intersected(QRectF(dirty));
+
+    if (!target.isEmpty()) {
+        QRectF source((target.left() - grid.left()) / cellWidth,
+                      (target.top() - grid.top()) / cellHeight,
+                      target.width() / cellWidth,
+                      target.height() / cellHeight);
+        painter.drawImage(target, gridLayer, source);
+    }
 
-    double gridWidth = cols * cellWidth;
-    double gridHeight = rows * cellHeight;
+    // --- Axes layer ---
+    qreal dpr = axesLayer.devicePixelRatio();
+    painter.drawPixmap(QRectF(dirty), axesLayer,
+                       QRectF(QPointF(dirty.topLeft()) * dpr, QSizeF(dirty.size()) * dpr));
 
-    double offsetX = (w - gridWidth) / 2.0;
-    double offsetY = (h - gridHeight) / 2.0;
+    // --- Overlay: hovered cell outline ---
+    if (hoverRow >= 0) {
+        painter.setPen(QPen(Qt::black, 1));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(cellRect(hoverRow, hoverCol).adjusted(1, 1, -2, -2));
+    }
+}
 
-    double x = event->pos().x();
-    double y = event->pos().y();
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+    axesDirty = true;   // grid is re-centred, labels move with it
+    picker.setView(QRectF(0, 0, cols, rows), gridRect());
+}
 
-    // Check if click is inside centered grid
-    if (x < offsetX || x > offsetX + gridWidth ||
-        y < offsetY || y > offsetY + gridHeight)
+void MainWindow::setHoverCell(int i, int j)
+{
+    if (i == hoverRow && j == hoverCol)
         return;
 
-    int j = (x - offsetX) / cellWidth;
-    int i = rows - 1 - ((y - offsetY) / cellHeight);
+    // Repaint just the old and the new cell
+    if (hoverRow >= 0)
+        update(cellRect(hoverRow, hoverCol));
+
+    hoverRow = i;
+    hoverCol = j;
+
+    if (hoverRow >= 0)
+        update(cellRect(hoverRow, hoverCol));
+}
 
-    if (i >= 0 && i < rows && j >= 0 && j < cols) {
-        int z = zValues[i][j];
-        QString msg = QString("X = %1\nY = %2\nZ = %3")
-                          .arg(j).arg(i).arg(z);
-        QMessageBox::information(this, "Cell Info", msg);
+// Outline + info box for the cell under pos (nothing modal: the event loop keeps running)
+void MainWindow::showCellInfo(const QPoint &pos)
+{
+    int i, j;
+
+    if (!cellAt(pos, &i, &j)) {
+        setHoverCell(-1, -1);
+        hoverInfo->hide();
+        return;
     }
+
+    setHoverCell(i, j);
+
+    int z = zValues.at(i, j);
+    QString msg = QString("X = %1\nY = %2\nZ = %3")
+                      .arg(j).arg(i).arg(z);
+    hoverInfo->showAt(pos, msg);
+}
+
+void MainWindow::mouseMoveEvent(QMouseEvent *event)
+{
+    showCellInfo(event->pos());
+}
+
+void MainWindow::leaveEvent(QEvent *event)
+{
+    Q_UNUSED(event);
+    setHoverCell(-1, -1);
+    hoverInfo->hide();
+}
+
+// Handle mouse clicks (detect which cell was clicked)
+void MainWindow::mousePressEvent(QMouseEvent *event)
+{
+    showCellInfo(event->pos());
 }
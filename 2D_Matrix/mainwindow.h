@@ -2,8 +2,12 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QVector>
 #include <QMouseEvent>
+#include <QImage>
+#include <QPixmap>
+#include "densegrid.h"
+#include "cellpicker.h"
+#include "hoveroverlay.h"
 
 // MainWindow is our custom QWidget that draws the square matrix
 
@@ -22,10 +26,38 @@ protected:
     //Handles mouse clicks
     void mousePressEvent(QMouseEvent *event) override;
 
+    //Moves the hover highlight
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
+    //Geometry changed -> axes layer must be redrawn
+    void resizeEvent(QResizeEvent *event) override;
+
 private:
+    // --- Layout (shared by painting and hit testing) ---
+    QRectF gridRect() const;                 // where the grid sits in the window
+    QRect cellRect(int i, int j) const;      // window rect of cell (row i, col j), for update()
+    bool cellAt(const QPointF &pos, int *i, int *j) const;
+
+    // --- Render layers ---
+    void rebuildGridLayer();                 // data changed
+    void rebuildAxesLayer();                 // geometry changed
+    void setHoverCell(int i, int j);         // overlay changed (only old + new cell repainted)
+    void showCellInfo(const QPoint &pos);    // hover box + outline for the cell under pos
+
     int rows; // number of rows(Y axis -> 0 to 60)
     int cols; // number of columns(X axis -> 0 to 360)
 
-    QVector<QVector<int>>zValues; // matrix of z values
+    DenseGrid<int> zValues; // matrix of z values (contiguous, row-major)
+
+    QImage gridLayer;   // one pixel per cell, already bottom-up
+    QPixmap axesLayer;  // axes, ticks and titles for the current window size
+    bool axesDirty;
+
+    int hoverRow;       // overlay: highlighted cell, -1 when none
+    int hoverCol;
+
+    CellPicker picker;      // window position <-> cell (grid rect, row 0 at the bottom)
+    HoverOverlay *hoverInfo; // non-modal cell value next to the cursor
 };
 #endif // MAINWINDOW_H
@@ -10,14 +10,18 @@ CONFIG += c++17
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    udptransfer.cpp
 
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    udptransfer.h
 
 FORMS += \
     mainwindow.ui
 
+include(../TransferCommon/TransferCommon.pri)
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
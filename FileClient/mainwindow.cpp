@@ -1,8 +1,12 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QFileDialog>
-#include <QFileInfo>
 #include <QDataStream>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+static const int MulticastTtl = 8;
+static const int PumpSliceMs = 5;        // max time spent sending per event-loop turn
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -12,10 +16,24 @@ MainWindow::MainWindow(QWidget *parent)
 
     udpSocket = new QUdpSocket(this);
 
+    // Random start so two clients feeding one server don't reuse transfer ids
+    nextTransferId = QRandomGenerator::global()->bounded(1u << 30);
+
+    pumpTimer = new QTimer(this);
+    pumpTimer->setSingleShot(true);
+    pumpTimer->setTimerType(Qt::PreciseTimer);
+
     ui->progressBar->setValue(0);
 
     connect(ui->btnBrowse, &QPushButton::clicked, this, &MainWindow::browseFile);
     connect(ui->btnSend, &QPushButton::clicked, this, &MainWindow::sendFileUdp);
+    connect(udpSocket, &QUdpSocket::readyRead, this, &MainWindow::readNacks);
+    connect(pumpTimer, &QTimer::timeout, this, &MainWindow::pumpTransfers);
+
+    // Rate caps in KB/s (0 = unlimited), adjustable while transfers run
+    connect(ui->globalRateSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::updateRateLimits);
+    connect(ui->peerRateSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::updateRateLimits);
+    updateRateLimits();
 }
 
 MainWindow::~MainWindow()
@@ -34,6 +52,11 @@ void MainWindow::browseFile()
     ui->textEditLog->append("✅ Selected: " + filePath);
 }
 
+void MainWindow::sendDatagram(const QByteArray &datagram, const QHostAddress &address, quint16 port)
+{
+    udpSocket->writeDatagram(cipher.seal(datagram), address, port);
+}
+
 void MainWindow::sendFileUdp()
 {
     QString ip = ui->ipEdit->text();
@@ -45,61 +68,168 @@ void MainWindow::sendFileUdp()
         return;
     }
 
-    QFile file(filePath);
+    UdpTransfer *transfer = new UdpTransfer(nextTransferId++, filePath, QHostAddress(ip), quint16(port), this);
 
-    if(!file.open(QIODevice::ReadOnly))
+    if(!transfer->open())
     {
         ui->textEditLog->append("❌ Cannot open file!");
+        delete transfer;
         return;
     }
 
-    QString fileName = QFileInfo(file).fileName();
-    qint64 fileSize = file.size();
+    // Key is shared by every transfer on this socket
+    if(transfers.isEmpty())
+        cipher.setPassphrase(ui->passphraseEdit->text());
 
-    int chunkSize = 1024;   // UDP safe size
-    int totalPackets = (int)((fileSize + chunkSize - 1) / chunkSize);
+    // Bind explicitly so receivers' NACKs come back to this socket
+    if(udpSocket->state() != QAbstractSocket::BoundState)
+        udpSocket->bind(QHostAddress::AnyIPv4, 0);
 
-    ui->textEditLog->append("📤 Sending: " + fileName);
-    ui->textEditLog->append("📦 Size: " + QString::number(fileSize));
-    ui->textEditLog->append("📦 Packets: " + QString::number(totalPackets));
+    if(transfer->address().isMulticast())
+    {
+        udpSocket->setSocketOption(QAbstractSocket::MulticastTtlOption, MulticastTtl);
+        udpSocket->setSocketOption(QAbstractSocket::MulticastLoopbackOption, 1);
+        ui->textEditLog->append("📡 Multicast to group " + ip);
+    }
+
+    ui->textEditLog->append("📤 Sending: " + transfer->fileName());
+    ui->textEditLog->append("📦 Size: " + QString::number(transfer->fileSize()));
+    ui->textEditLog->append("📦 Packets: " + QString::number(transfer->totalPackets()));
 
-    // ✅ META datagram
-    QByteArray metaDatagram;
-    QDataStream metaOut(&metaDatagram, QIODevice::WriteOnly);
-    metaOut.setVersion(QDataStream::Qt_5_15);
+    if(cipher.isEnabled())
+        ui->textEditLog->append("🔒 Encrypted (AES-256-GCM)");
 
-    metaOut << QString("META") << fileName << fileSize << totalPackets;
+    // 0 = Urgent, 1 = Normal, 2 = Background
+    TransferScheduler::Priority priority =
+            TransferScheduler::Priority(qBound(0, ui->priorityCombo->currentIndex(), 2));
 
-    udpSocket->writeDatagram(metaDatagram, QHostAddress(ip), port);
+    transfers.insert(transfer->id(), transfer);
+    scheduler.addTransfer(int(transfer->id()), ip, priority);
+    scheduler.setActive(int(transfer->id()), true);
 
-    int sentPackets = 0;
+    connect(transfer, &UdpTransfer::message, ui->textEditLog, &QTextEdit::append);
+    connect(transfer, &UdpTransfer::pendingChanged, this, [this, transfer]() {
+        scheduler.setActive(int(transfer->id()), true);
+        schedulePump();
+    });
+    connect(transfer, &UdpTransfer::finished, this, &MainWindow::transferFinished);
+
+    // META goes out first through the scheduler, like every other datagram
+    ui->progressBar->setValue(0);
+    schedulePump();
+}
 
-    // ✅ DATA datagrams
-    for(int i = 0; i < totalPackets; i++)
+void MainWindow::pumpTransfers()
+{
+    const qint64 packetBytes = UdpTransfer::ChunkSize + 64 + (cipher.isEnabled() ? DatagramCipher::Overhead : 0);
+
+    QElapsedTimer slice;
+    slice.start();
+
+    // Send until every transfer is throttled / idle, or the slice is used up
+    while(slice.elapsed() < PumpSliceMs)
     {
-        QByteArray chunk = file.read(chunkSize);
+        int id = scheduler.pick(packetBytes);
 
-        QByteArray dataDatagram;
-        QDataStream out(&dataDatagram, QIODevice::WriteOnly);
-        out.setVersion(QDataStream::Qt_5_15);
+        if(id < 0)
+            break;
 
-        out << QString("DATA") << i << chunk;
+        UdpTransfer *transfer = transfers.value(quint32(id));
 
-        udpSocket->writeDatagram(dataDatagram, QHostAddress(ip), port);
+        sendDatagram(transfer->takeNextDatagram(), transfer->address(), transfer->port());
 
-        sentPackets++;
-        int progress = (sentPackets * 100) / totalPackets;
-        ui->progressBar->setValue(progress);
+        if(!transfer->hasPending())
+        {
+            scheduler.setActive(id, false);
+            ui->textEditLog->append("✅ " + transfer->fileName() + " sent (UDP), waiting for NACK / DONE...");
+        }
+
+        ui->progressBar->setValue(transfer->progress());
     }
 
-    // ✅ END datagram
-    QByteArray endDatagram;
-    QDataStream endOut(&endDatagram, QIODevice::WriteOnly);
-    endOut.setVersion(QDataStream::Qt_5_15);
-    endOut << QString("END");
+    schedulePump();
+}
+
+void MainWindow::schedulePump()
+{
+    if(!scheduler.hasActive())
+        return;
+
+    const qint64 packetBytes = UdpTransfer::ChunkSize + 64 + (cipher.isEnabled() ? DatagramCipher::Overhead : 0);
+    int wait = scheduler.msUntilReady(packetBytes);
 
-    udpSocket->writeDatagram(endDatagram, QHostAddress(ip), port);
+    if(!pumpTimer->isActive())
+        pumpTimer->start(qMax(0, wait));
+}
 
-    ui->textEditLog->append("✅ File Sent Successfully (UDP)!");
-    ui->progressBar->setValue(100);
+void MainWindow::updateRateLimits()
+{
+    scheduler.setGlobalRate(qint64(ui->globalRateSpin->value()) * 1024);
+    scheduler.setDefaultPeerRate(qint64(ui->peerRateSpin->value()) * 1024);
+}
+
+void MainWindow::transferFinished()
+{
+    UdpTransfer *transfer = qobject_cast<UdpTransfer *>(sender());
+
+    if(!transfer)
+        return;
+
+    scheduler.removeTransfer(int(transfer->id()));
+    transfers.remove(transfer->id());
+    transfer->deleteLater();
+
+    if(transfers.isEmpty())
+        ui->progressBar->setValue(100);
+}
+
+void MainWindow::readNacks()
+{
+    while(udpSocket->hasPendingDatagrams())
+    {
+        QByteArray datagram;
+        datagram.resize(int(udpSocket->pendingDatagramSize()));
+
+        QHostAddress sender;
+        quint16 senderPort;
+
+        udpSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+
+        QByteArray payload;
+        if(!cipher.open(datagram, &payload))
+            continue;
+
+        QDataStream in(&payload, QIODevice::ReadOnly);
+        in.setVersion(QDataStream::Qt_5_15);
+
+        QString type;
+        quint32 transferId;
+        in >> type >> transferId;
+
+        UdpTransfer *transfer = transfers.value(transferId);
+
+        if(!transfer)
+            continue;
+
+        const QString receiver = sender.toString() + ":" + QString::number(senderPort);
+
+        // Positive completion ACK from one receiver
+        if(type == "DONE")
+        {
+            transfer->addDone(receiver);
+            ui->textEditLog->append("☑ DONE from " + receiver);
+            continue;
+        }
+
+        if(type != "NACK")
+            continue;
+
+        QVector<UdpTransfer::Range> ranges;
+        in >> ranges;
+
+        transfer->addNack(receiver, ranges);
+
+        ui->textEditLog->append("↩ NACK from " + sender.toString() + ": " +
+                                QString::number(ranges.size()) + " missing ranges");
+    }
 }
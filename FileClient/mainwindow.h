@@ -3,7 +3,11 @@
 
 #include <QMainWindow>
 #include <QUdpSocket>
-#include <QFile>
+#include <QTimer>
+#include <QMap>
+#include "datagramcipher.h"
+#include "transferscheduler.h"
+#include "udptransfer.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -20,12 +24,27 @@ public:
 private slots:
     void browseFile();
     void sendFileUdp();
+    void readNacks();
+    void pumpTransfers();
+    void updateRateLimits();
+    void transferFinished();
 
 private:
+    void sendDatagram(const QByteArray &datagram, const QHostAddress &address, quint16 port);
+    void schedulePump();
+
     Ui::MainWindow *ui;
 
     QUdpSocket *udpSocket;
     QString filePath;
+
+    DatagramCipher cipher;
+
+    // Concurrent transfers share the socket; the scheduler decides who sends next
+    QMap<quint32, UdpTransfer *> transfers;
+    TransferScheduler scheduler;
+    QTimer *pumpTimer;
+    quint32 nextTransferId;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,217 @@
+#include "udptransfer.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <QStringList>
+#include <algorithm>
+
+static const int NackWindowMs = 300;     // how long to collect NACKs after each END
+static const int MaxRepairRounds = 10;
+
+UdpTransfer::UdpTransfer(quint32 id, const QString &filePath,
+                         const QHostAddress &address, quint16 port, QObject *parent)
+    : QObject(parent)
+    , transferId(id)
+    , file(filePath)
+    , destAddress(address)
+    , destPort(port)
+    , packetCount(0)
+    , nextPacket(0)
+    , resendNext(0)
+    , endPending(false)
+    , metaPending(false)
+    , nackCount(0)
+    , repairRound(0)
+{
+    repairTimer.setSingleShot(true);
+    repairTimer.setInterval(NackWindowMs);
+
+    connect(&repairTimer, &QTimer::timeout, this, &UdpTransfer::repairTimeout);
+}
+
+bool UdpTransfer::open()
+{
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    packetCount = (file.size() + ChunkSize - 1) / ChunkSize;
+    nextPacket = 0;
+    metaPending = true;
+    endPending = true;
+    return true;
+}
+
+QString UdpTransfer::fileName() const
+{
+    return QFileInfo(file).fileName();
+}
+
+QByteArray UdpTransfer::metaDatagram() const
+{
+    QByteArray metaDatagram;
+    QDataStream metaOut(&metaDatagram, QIODevice::WriteOnly);
+    metaOut.setVersion(QDataStream::Qt_5_15);
+
+    metaOut << QString("META") << transferId << fileName() << file.size() << packetCount << int(ChunkSize);
+
+    return metaDatagram;
+}
+
+bool UdpTransfer::hasPending() const
+{
+    return metaPending || nextPacket < packetCount || !resendQueue.isEmpty() || endPending;
+}
+
+QByteArray UdpTransfer::takeNextDatagram()
+{
+    // ✅ META, first in every round (receivers that missed it can join late)
+    if(metaPending)
+    {
+        metaPending = false;
+        return metaDatagram();
+    }
+
+    // ✅ DATA, first pass
+    if(nextPacket < packetCount)
+    {
+        qint64 packetNo = nextPacket++;
+        return dataDatagram(packetNo, file.read(ChunkSize));
+    }
+
+    // 🔁 DATA, repair round
+    if(!resendQueue.isEmpty())
+    {
+        Range &range = resendQueue.first();
+
+        if(resendNext < range.first || resendNext > range.second)
+        {
+            resendNext = range.first;
+            file.seek(resendNext * ChunkSize);
+        }
+
+        qint64 packetNo = resendNext++;
+        QByteArray datagram = dataDatagram(packetNo, file.read(ChunkSize));
+
+        if(resendNext > range.second)
+            resendQueue.removeFirst();
+
+        return datagram;
+    }
+
+    // ✅ END, then wait for NACKs
+    endPending = false;
+
+    QByteArray endDatagram;
+    QDataStream endOut(&endDatagram, QIODevice::WriteOnly);
+    endOut.setVersion(QDataStream::Qt_5_15);
+    endOut << QString("END") << transferId;
+
+    nackRanges.clear();
+    nackCount = 0;
+    repairTimer.start();
+
+    return endDatagram;
+}
+
+int UdpTransfer::progress() const
+{
+    if(packetCount == 0)
+        return 100;
+
+    return int((100.0 * nextPacket) / packetCount);
+}
+
+void UdpTransfer::addNack(const QString &receiver, const QVector<Range> &ranges)
+{
+    receivers.insert(receiver);
+    confirmed.remove(receiver);
+
+    if(!repairTimer.isActive())
+        return;
+
+    nackRanges += ranges;
+    nackCount++;
+}
+
+void UdpTransfer::addDone(const QString &receiver)
+{
+    receivers.insert(receiver);
+    confirmed.insert(receiver);
+}
+
+QByteArray UdpTransfer::dataDatagram(qint64 packetNo, const QByteArray &chunk) const
+{
+    QByteArray dataDatagram;
+    QDataStream out(&dataDatagram, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_15);
+
+    out << QString("DATA") << transferId << packetNo << chunk;
+
+    return dataDatagram;
+}
+
+void UdpTransfer::repairTimeout()
+{
+    // Complete only on positive confirmation from every receiver we know of
+    if(nackRanges.isEmpty() && !confirmed.isEmpty() && confirmed.contains(receivers))
+    {
+        emit message("✅ " + fileName() + ": " + QString::number(confirmed.size()) +
+                     " receiver(s) confirmed complete!");
+        file.close();
+        emit finished();
+        return;
+    }
+
+    if(++repairRound > MaxRepairRounds)
+    {
+        QStringList pending = (receivers - confirmed).values();
+
+        emit message("❌ " + fileName() + ": giving up after " +
+                     QString::number(MaxRepairRounds) + " repair rounds, " +
+                     (confirmed.isEmpty() && pending.isEmpty() ? QString("no receiver answered!")
+                                                               : "unconfirmed: " + pending.join(", ")));
+        file.close();
+        emit finished();
+        return;
+    }
+
+    // Union of every receiver's gaps: sort + merge overlapping/adjacent ranges
+    std::sort(nackRanges.begin(), nackRanges.end());
+
+    qint64 repaired = 0;
+
+    for(const Range &range : nackRanges)
+    {
+        qint64 first = qMax<qint64>(range.first, 0);
+        qint64 last = qMin(range.second, packetCount - 1);
+
+        if(first > last)
+            continue;
+
+        if(!resendQueue.isEmpty() && first <= resendQueue.last().second + 1)
+        {
+            qint64 previousLast = resendQueue.last().second;
+            resendQueue.last().second = qMax(previousLast, last);
+            repaired += qMax<qint64>(0, resendQueue.last().second - previousLast);
+        }
+        else
+        {
+            resendQueue.append(Range(first, last));
+            repaired += last - first + 1;
+        }
+    }
+
+    resendNext = -1;
+    metaPending = true;
+    endPending = true;
+
+    if(repaired > 0)
+        emit message("🔁 " + fileName() + ": repair round " + QString::number(repairRound) +
+                     ", resending " + QString::number(repaired) + " packets for " +
+                     QString::number(nackCount) + " NACKs");
+    else
+        emit message("🔁 " + fileName() + ": no confirmation yet, repeating META / END (round " +
+                     QString::number(repairRound) + ")");
+
+    nackRanges.clear();
+    emit pendingChanged();
+}
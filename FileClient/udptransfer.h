@@ -0,0 +1,87 @@
+#ifndef UDPTRANSFER_H
+#define UDPTRANSFER_H
+
+#include <QObject>
+#include <QFile>
+#include <QHostAddress>
+#include <QTimer>
+#include <QVector>
+#include <QPair>
+#include <QSet>
+
+// One outgoing UDP file transfer.
+// Produces META / DATA / END datagrams on demand (the window decides when,
+// via TransferScheduler), collects NACKs after each END and queues the
+// union of all reported gaps for the next repair round.
+// Silence is not success: the transfer only completes once at least one
+// receiver, and every receiver that ever NACKed, has sent DONE. Until then
+// each round repeats META and END, so a receiver that missed either one
+// still gets to NACK its gaps.
+class UdpTransfer : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QPair<qint64, qint64> Range;   // inclusive [first, last] packet numbers
+
+    UdpTransfer(quint32 id, const QString &filePath,
+                const QHostAddress &address, quint16 port, QObject *parent = nullptr);
+
+    bool open();
+
+    quint32 id() const { return transferId; }
+    QHostAddress address() const { return destAddress; }
+    quint16 port() const { return destPort; }
+    QString fileName() const;
+    qint64 fileSize() const { return file.size(); }
+    qint64 totalPackets() const { return packetCount; }
+    int chunkSize() const { return ChunkSize; }
+
+    QByteArray metaDatagram() const;
+
+    // True while a DATA or END datagram is waiting to be sent
+    bool hasPending() const;
+    QByteArray takeNextDatagram();
+
+    // First-pass progress 0-100
+    int progress() const;
+
+    // receiver = "address:port" of the replying server
+    void addNack(const QString &receiver, const QVector<Range> &ranges);
+    void addDone(const QString &receiver);
+
+    enum { ChunkSize = 1024 };   // UDP safe size (plus DatagramCipher::Overhead when encrypted)
+
+signals:
+    void message(const QString &text);
+    void pendingChanged();       // a repair round queued more datagrams
+    void finished();
+
+private slots:
+    void repairTimeout();
+
+private:
+    QByteArray dataDatagram(qint64 packetNo, const QByteArray &chunk) const;
+
+    quint32 transferId;
+    QFile file;
+    QHostAddress destAddress;
+    quint16 destPort;
+    qint64 packetCount;
+
+    qint64 nextPacket;           // first pass: sequential reads
+    QVector<Range> resendQueue;  // repair rounds: merged NACK ranges
+    qint64 resendNext;
+    bool endPending;
+    bool metaPending;
+
+    QTimer repairTimer;
+    QVector<Range> nackRanges;
+    int nackCount;
+    int repairRound;
+
+    QSet<QString> receivers;     // every server that replied so far
+    QSet<QString> confirmed;     // ... and those that reported the file complete
+};
+
+#endif // UDPTRANSFER_H
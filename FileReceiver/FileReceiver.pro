@@ -10,10 +10,12 @@ CONFIG += c++17
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    sslserver.cpp
 
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    sslserver.h
 
 FORMS += \
     mainwindow.ui
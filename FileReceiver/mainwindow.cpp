@@ -3,6 +3,7 @@
 #include <QDataStream>
 #include <QDebug>
 #include <QDir>
+#include <QCoreApplication>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -10,7 +11,7 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    server = new QTcpServer(this);
+    server = new SslServer(this);
     socket = nullptr;
 
     fileSize = 0;
@@ -30,6 +31,22 @@ void MainWindow::startServer()
 {
     int port = ui->portEdit->text().toInt();
 
+    // TLS: server.crt / server.key (PEM) next to the executable
+    server->setEncryptionEnabled(ui->chkEncrypt->isChecked());
+
+    if(server->isEncryptionEnabled())
+    {
+        QString dir = QCoreApplication::applicationDirPath();
+
+        if(!server->loadCertificate(dir + "/server.crt", dir + "/server.key"))
+        {
+            ui->textEditLog->append("❌ Cannot load server.crt / server.key!");
+            return;
+        }
+
+        ui->textEditLog->append("🔒 TLS enabled");
+    }
+
     if(server->listen(QHostAddress::Any, port))
     {
         ui->textEditLog->append("✅ Server started on port: " + QString::number(port));
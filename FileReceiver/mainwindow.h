@@ -2,7 +2,7 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTcpServer>
+#include "sslserver.h"
 #include <QTcpSocket>
 #include <QFile>
 
@@ -26,7 +26,7 @@ private slots:
 private:
     Ui::MainWindow *ui;
 
-    QTcpServer *server;
+    SslServer *server;
     QTcpSocket *socket;
 
     QFile file;
@@ -0,0 +1,49 @@
+#include "sslserver.h"
+#include <QSslSocket>
+#include <QFile>
+
+SslServer::SslServer(QObject *parent)
+    : QTcpServer(parent)
+    , encryptionEnabled(false)
+{
+}
+
+bool SslServer::loadCertificate(const QString &certPath, const QString &keyPath)
+{
+    QFile certFile(certPath);
+    QFile keyFile(keyPath);
+
+    if(!certFile.open(QIODevice::ReadOnly) || !keyFile.open(QIODevice::ReadOnly))
+        return false;
+
+    certificate = QSslCertificate(&certFile, QSsl::Pem);
+    privateKey = QSslKey(&keyFile, QSsl::Rsa, QSsl::Pem);
+
+    if(privateKey.isNull())
+    {
+        keyFile.seek(0);
+        privateKey = QSslKey(&keyFile, QSsl::Ec, QSsl::Pem);
+    }
+
+    return !certificate.isNull() && !privateKey.isNull();
+}
+
+void SslServer::incomingConnection(qintptr socketDescriptor)
+{
+    QSslSocket *socket = new QSslSocket(this);
+
+    if(!socket->setSocketDescriptor(socketDescriptor))
+    {
+        delete socket;
+        return;
+    }
+
+    if(encryptionEnabled)
+    {
+        socket->setLocalCertificate(certificate);
+        socket->setPrivateKey(privateKey);
+        socket->startServerEncryption();
+    }
+
+    addPendingConnection(socket);
+}
@@ -0,0 +1,31 @@
+#ifndef SSLSERVER_H
+#define SSLSERVER_H
+
+#include <QTcpServer>
+#include <QSslCertificate>
+#include <QSslKey>
+
+// QTcpServer that hands out QSslSockets and, when encryption is enabled,
+// starts the TLS handshake on every accepted connection.
+class SslServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit SslServer(QObject *parent = nullptr);
+
+    bool loadCertificate(const QString &certPath, const QString &keyPath);
+
+    void setEncryptionEnabled(bool enabled) { encryptionEnabled = enabled; }
+    bool isEncryptionEnabled() const { return encryptionEnabled; }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+    QSslCertificate certificate;
+    QSslKey privateKey;
+    bool encryptionEnabled;
+};
+
+#endif // SSLSERVER_H
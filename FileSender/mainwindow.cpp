@@ -3,6 +3,7 @@
 #include <QFileDialog>
 #include <QDataStream>
 #include <QFileInfo>
+#include <QCoreApplication>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -10,7 +11,7 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    socket = new QTcpSocket(this);
+    socket = new QSslSocket(this);
 
     ui->progressBar->setValue(0);
 
@@ -53,16 +54,45 @@ void MainWindow::sendFile()
         return;
     }
 
-    socket->connectToHost(ip, port);
+    bool encrypted = ui->chkEncrypt->isChecked();
 
-    if(!socket->waitForConnected(5000))
+    if(encrypted)
+    {
+        // Trust the receiver's self-signed server.crt when shipped next to the executable
+        QList<QSslCertificate> pinned =
+            QSslCertificate::fromPath(QCoreApplication::applicationDirPath() + "/server.crt");
+
+        if(!pinned.isEmpty())
+        {
+            QSslConfiguration config = socket->sslConfiguration();
+            config.addCaCertificates(pinned);
+            socket->setSslConfiguration(config);
+            socket->ignoreSslErrors({ QSslError(QSslError::HostNameMismatch, pinned.first()) });
+        }
+
+        socket->connectToHostEncrypted(ip, port);
+    }
+    else
+    {
+        socket->connectToHost(ip, port);
+    }
+
+    bool connected = encrypted ? socket->waitForEncrypted(5000)
+                               : socket->waitForConnected(5000);
+
+    if(!connected)
     {
         ui->textEditLog->append("❌ Connection failed!");
+
+        if(encrypted)
+            ui->textEditLog->append("❌ TLS: " + socket->errorString());
+
+        socket->abort();
         file.close();
         return;
     }
 
-    ui->textEditLog->append("✅ Connected to server!");
+    ui->textEditLog->append(encrypted ? "🔒 Connected to server (TLS)!" : "✅ Connected to server!");
 
     QString fileName = QFileInfo(file).fileName();
     qint64 fileSize = file.size();
@@ -76,9 +106,12 @@ void MainWindow::sendFile()
 
     qint64 sentBytes = 0;
 
+    // 64 KB batches: fewer write/flush round trips, and TLS can fill whole records
+    const qint64 batchSize = 64 * 1024;
+
     while(!file.atEnd())
     {
-        QByteArray buffer = file.read(4096);
+        QByteArray buffer = file.read(batchSize);
         sentBytes += socket->write(buffer);
         socket->waitForBytesWritten();
 
@@ -2,7 +2,7 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTcpSocket>
+#include <QSslSocket>
 #include <QFile>
 
 QT_BEGIN_NAMESPACE
@@ -24,7 +24,7 @@ private slots:
 private:
     Ui::MainWindow *ui;
 
-    QTcpSocket *socket;
+    QSslSocket *socket;
     QFile file;
     QString filePath;
 };
@@ -3,19 +3,53 @@
 #include <QDataStream>
 #include <QFileInfo>
 #include <QDir>
+#include <QRandomGenerator>
+#include <algorithm>
+
+static const int MaxNackRanges = 64;    // keeps a NACK well inside one datagram
+static const int MaxNackDelayMs = 150;  // multicast; the sender collects NACKs for 300 ms
+static const int TransferIdleMs = 60000; // far longer than a sender keeps repeating META / END
+
+// True if every gap lies inside the union of ranges
+static bool coveredBy(QVector<ReceivedPacketSet::Range> ranges, const QVector<ReceivedPacketSet::Range> &gaps)
+{
+    std::sort(ranges.begin(), ranges.end());
+
+    for(const ReceivedPacketSet::Range &gap : gaps)
+    {
+        bool covered = false;
+        qint64 next = gap.first;         // first packet of the gap not covered so far
+
+        for(const ReceivedPacketSet::Range &range : ranges)
+        {
+            if(range.first > next)
+                break;
+
+            if(range.second >= gap.second)
+            {
+                covered = true;
+                break;
+            }
+
+            next = qMax(next, range.second + 1);
+        }
+
+        if(!covered)
+            return false;
+    }
+
+    return true;
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , serverPort(0)
 {
     ui->setupUi(this);
 
     udpSocket = new QUdpSocket(this);
 
-    fileSize = 0;
-    totalPackets = 0;
-    receivedPackets = 0;
-
     ui->progressBar->setValue(0);
 
     connect(ui->btnStartServer, &QPushButton::clicked, this, &MainWindow::startServer);
@@ -23,6 +57,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    qDeleteAll(transfers);
     delete ui;
 }
 
@@ -30,9 +65,35 @@ void MainWindow::startServer()
 {
     int port = ui->portEdit->text().toInt();
 
-    if(udpSocket->bind(QHostAddress::Any, port))
+    cipher.setPassphrase(ui->passphraseEdit->text());
+
+    // Optional multicast group: several servers can share the port and one transmission
+    QHostAddress group(ui->groupEdit->text().trimmed());
+    bool multicast = group.isMulticast();
+
+    bool bound = multicast
+            ? udpSocket->bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)
+            : udpSocket->bind(QHostAddress::Any, port);
+
+    if(bound)
     {
         ui->textEditLog->append("✅ UDP Server Started on port: " + QString::number(port));
+        serverPort = quint16(port);
+
+        if(multicast)
+        {
+            if(udpSocket->joinMulticastGroup(group))
+            {
+                multicastGroup = group;
+                ui->textEditLog->append("📡 Joined multicast group " + group.toString());
+            }
+            else
+                ui->textEditLog->append("❌ Failed to join multicast group " + group.toString());
+        }
+
+        if(cipher.isEnabled())
+            ui->textEditLog->append("🔒 Expecting encrypted datagrams (AES-256-GCM)");
+
         connect(udpSocket, &QUdpSocket::readyRead, this, &MainWindow::readPendingDatagrams);
     }
     else
@@ -53,81 +114,263 @@ void MainWindow::readPendingDatagrams()
 
         udpSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
 
-        QDataStream in(&datagram, QIODevice::ReadOnly);
+        QByteArray payload;
+        if(!cipher.open(datagram, &payload))
+            continue;   // wrong key, tampered or plaintext datagram
+
+        QDataStream in(&payload, QIODevice::ReadOnly);
         in.setVersion(QDataStream::Qt_5_15);
 
         QString type;
-        in >> type;
+        quint32 packetTransferId;
+        in >> type >> packetTransferId;
 
-        // 1) META packet
+        // 1) META packet: starts a transfer. It repeats every round, so only
+        // the first one for an id counts
         if(type == "META")
         {
-            packetBuffer.clear();
-
-            in >> fileName;
-            in >> fileSize;
-            in >> totalPackets;
+            if(!transfers.contains(packetTransferId) && !rejectedIds.contains(packetTransferId))
+                startTransfer(packetTransferId, in);
 
-            receivedPackets = 0;
-
-            ui->textEditLog->append("📁 Incoming File: " + fileName);
-            ui->textEditLog->append("📦 File Size: " + QString::number(fileSize));
-            ui->textEditLog->append("📦 Total Packets: " + QString::number(totalPackets));
+            continue;
+        }
 
-            ui->progressBar->setValue(0);
-            ui->lblStatus->setText("Receiving...");
+        IncomingTransfer *transfer = transfers.value(packetTransferId);
 
+        // Unknown (META missed or rejected): the sender repeats META until we confirm
+        if(!transfer)
             continue;
-        }
+
+        transfer->idleTimer.start();
 
         // 2) DATA packet
         if(type == "DATA")
         {
-            int packetNo;
+            qint64 packetNo;
             QByteArray chunk;
             in >> packetNo;
             in >> chunk;
 
-            if(!packetBuffer.contains(packetNo))
+            // Every chunk but the last is exactly the negotiated size
+            if(in.status() != QDataStream::Ok || packetNo < 0 || packetNo >= transfer->totalPackets)
+                continue;
+
+            const qint64 expectedSize = packetNo == transfer->totalPackets - 1
+                    ? transfer->fileSize - packetNo * transfer->chunkSize
+                    : transfer->chunkSize;
+
+            if(!transfer->file.isOpen() || chunk.size() != expectedSize)
+                continue;
+
+            if(transfer->receivedSet.insert(packetNo))
             {
-                packetBuffer[packetNo] = chunk;
-                receivedPackets++;
+                transfer->file.seek(packetNo * transfer->chunkSize);
+                transfer->file.write(chunk);
             }
 
-            int progress = (receivedPackets * 100) / totalPackets;
+            if(transfer->totalPackets == 0)
+                continue;
+
+            qint64 receivedPackets = transfer->receivedSet.receivedCount();
+            int progress = int((100.0 * receivedPackets) / transfer->totalPackets);
             ui->progressBar->setValue(progress);
 
             ui->lblStatus->setText("Packets: " + QString::number(receivedPackets) +
-                                   "/" + QString::number(totalPackets));
+                                   "/" + QString::number(transfer->totalPackets));
 
             continue;
         }
 
-        // 3) END packet
-        if(type == "END")
+        // 3) NACK another receiver sent to the group: its gaps are repaired
+        // for everyone, so ours need not be reported again
+        if(type == "NACK")
         {
-            ui->textEditLog->append("✅ All packets received. Saving file...");
+            QVector<ReceivedPacketSet::Range> ranges;
+            in >> ranges;
 
-            QString savePath = QDir::homePath() + "/Desktop/UDP_Received_" + fileName;
+            if(transfer->nackTimer.isActive() && in.status() == QDataStream::Ok)
+                transfer->heardNacks += ranges;
 
-            file.setFileName(savePath);
+            continue;
+        }
 
-            if(!file.open(QIODevice::WriteOnly))
+        // 4) END packet: NACK the gaps, or save once everything is here and
+        // confirm with DONE. END repeats until the sender has our DONE, so a
+        // saved file is confirmed again (the previous DONE may have been lost).
+        if(type == "END")
+        {
+            if(transfer->saved)
             {
-                ui->textEditLog->append("❌ Cannot save file!");
-                return;
+                sendDone(packetTransferId, sender, senderPort);
+                continue;
             }
 
-            for(int i = 0; i < totalPackets; i++)
+            if(!transfer->file.isOpen())
+                continue;
+
+            if(!transfer->receivedSet.isComplete())
             {
-                file.write(packetBuffer[i]);
+                transfer->nackAddress = sender;
+                transfer->nackPort = senderPort;
+
+                // Multicast: every receiver answers the same END. A random delay
+                // spreads the NACKs out and lets each receiver hear the others'
+                // first, so the sender gets about one NACK per gap, not one per receiver
+                if(multicastGroup.isNull())
+                {
+                    sendNack(packetTransferId);
+                }
+                else if(!transfer->nackTimer.isActive())
+                {
+                    transfer->heardNacks.clear();
+                    transfer->nackTimer.start(int(QRandomGenerator::global()->bounded(MaxNackDelayMs)));
+                }
+
+                continue;
             }
 
-            file.close();
+            ui->textEditLog->append("✅ " + transfer->fileName + ": all packets received. Saving file...");
 
-            ui->textEditLog->append("✅ File Saved: " + savePath);
+            transfer->file.close();
+            QFile::remove(transfer->savePath);
+
+            if(!transfer->file.rename(transfer->savePath))
+            {
+                ui->textEditLog->append("❌ Cannot save file!");
+                continue;
+            }
+
+            transfer->saved = true;
+            transfer->receivedSet.reset(0);       // bitmap no longer needed
+            sendDone(packetTransferId, sender, senderPort);
+
+            ui->textEditLog->append("✅ File Saved: " + transfer->savePath);
             ui->lblStatus->setText("✅ Completed!");
             ui->progressBar->setValue(100);
         }
     }
 }
+
+void MainWindow::startTransfer(quint32 id, QDataStream &in)
+{
+    IncomingTransfer *transfer = new IncomingTransfer;
+
+    in >> transfer->fileName;
+    in >> transfer->fileSize;
+    in >> transfer->totalPackets;
+    in >> transfer->chunkSize;
+
+    // Untrusted sizes: chunk size positive, packet count matching the file size
+    const qint64 fileSize = transfer->fileSize;
+    const int chunkSize = transfer->chunkSize;
+    bool sizesValid = in.status() == QDataStream::Ok && chunkSize > 0 && fileSize >= 0
+            && transfer->totalPackets == fileSize / chunkSize + (fileSize % chunkSize != 0 ? 1 : 0);
+
+    if(!sizesValid || !transfer->receivedSet.reset(transfer->totalPackets))
+    {
+        rejectTransfer(id, "❌ Rejected META: invalid sizes or bitmap too large!");
+        delete transfer;
+        return;
+    }
+
+    ui->textEditLog->append("📁 Incoming File: " + transfer->fileName);
+    ui->textEditLog->append("📦 File Size: " + QString::number(fileSize));
+    ui->textEditLog->append("📦 Total Packets: " + QString::number(transfer->totalPackets));
+
+    // Chunks are written straight to their offset in a .part file, so memory
+    // use does not grow with the file size. The id keeps two transfers of the
+    // same name apart
+    transfer->savePath = QDir::homePath() + "/Desktop/UDP_Received_" + QFileInfo(transfer->fileName).fileName();
+    transfer->file.setFileName(transfer->savePath + "." + QString::number(id) + ".part");
+
+    if(!transfer->file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !transfer->file.resize(fileSize))
+    {
+        rejectTransfer(id, "❌ Cannot create file!");
+        delete transfer;
+        return;
+    }
+
+    transfer->nackTimer.setSingleShot(true);
+    connect(&transfer->nackTimer, &QTimer::timeout, this, [this, id]() { sendNack(id); });
+
+    // Queued: the timer is deleted with the transfer, not while it emits
+    transfer->idleTimer.setSingleShot(true);
+    transfer->idleTimer.setInterval(TransferIdleMs);
+    connect(&transfer->idleTimer, &QTimer::timeout, this, [this, id]() { dropTransfer(id); }, Qt::QueuedConnection);
+    transfer->idleTimer.start();
+
+    transfers.insert(id, transfer);
+
+    ui->progressBar->setValue(0);
+    ui->lblStatus->setText("Receiving...");
+}
+
+void MainWindow::rejectTransfer(quint32 id, const QString &reason)
+{
+    ui->textEditLog->append(reason);
+
+    rejectedIds.insert(id);
+    QTimer::singleShot(TransferIdleMs, this, [this, id]() { rejectedIds.remove(id); });
+}
+
+void MainWindow::dropTransfer(quint32 id)
+{
+    IncomingTransfer *transfer = transfers.value(id);
+    if(!transfer || transfer->idleTimer.isActive())
+        return;     // gone already, or a datagram arrived since the timeout
+
+    transfers.remove(id);
+
+    if(!transfer->saved)
+    {
+        ui->textEditLog->append("⌛ " + transfer->fileName + ": sender went quiet, transfer dropped");
+        transfer->file.remove();
+    }
+
+    delete transfer;
+}
+
+void MainWindow::sendNack(quint32 id)
+{
+    IncomingTransfer *transfer = transfers.value(id);
+    if(!transfer || transfer->saved || !transfer->file.isOpen())
+        return;
+
+    const ReceivedPacketSet &receivedSet = transfer->receivedSet;
+    QVector<ReceivedPacketSet::Range> missing = receivedSet.missingRanges(MaxNackRanges);
+
+    if(missing.isEmpty())
+        return;     // late DATA filled the gaps while the NACK waited
+
+    if(!multicastGroup.isNull() && coveredBy(transfer->heardNacks, missing))
+    {
+        ui->textEditLog->append("🤫 " + transfer->fileName + ": gaps already NACKed by another receiver");
+        return;
+    }
+
+    QByteArray nackDatagram;
+    QDataStream nackOut(&nackDatagram, QIODevice::WriteOnly);
+    nackOut.setVersion(QDataStream::Qt_5_15);
+    nackOut << QString("NACK") << id << missing;
+
+    const QByteArray sealed = cipher.seal(nackDatagram);
+    udpSocket->writeDatagram(sealed, transfer->nackAddress, transfer->nackPort);
+
+    // The other receivers hear it too and hold back the same gaps
+    if(!multicastGroup.isNull())
+        udpSocket->writeDatagram(sealed, multicastGroup, serverPort);
+
+    ui->textEditLog->append("↩ " + transfer->fileName + ": missing " +
+                            QString::number(receivedSet.size() - receivedSet.receivedCount()) +
+                            " packets, NACK sent (" + QString::number(missing.size()) + " ranges)");
+}
+
+void MainWindow::sendDone(quint32 id, const QHostAddress &address, quint16 port)
+{
+    QByteArray doneDatagram;
+    QDataStream doneOut(&doneDatagram, QIODevice::WriteOnly);
+    doneOut.setVersion(QDataStream::Qt_5_15);
+    doneOut << QString("DONE") << id;
+
+    udpSocket->writeDatagram(cipher.seal(doneDatagram), address, port);
+}
@@ -4,7 +4,12 @@
 #include <QMainWindow>
 #include <QUdpSocket>
 #include <QFile>
+#include <QDataStream>
 #include <QMap>
+#include <QSet>
+#include <QTimer>
+#include "receivedpacketset.h"
+#include "datagramcipher.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -23,17 +28,58 @@ private slots:
     void readPendingDatagrams();
 
 private:
+    // One incoming file; several senders can transfer at the same time
+    struct IncomingTransfer
+    {
+        QString fileName;
+        QString savePath;
+        qint64 fileSize = 0;
+        qint64 totalPackets = 0;
+        int chunkSize = 0;
+        bool saved = false;
+
+        QFile file;                  // <savePath>.<id>.part while receiving
+        ReceivedPacketSet receivedSet;
+
+        // Multicast: the NACK for an END waits a random delay, and gaps another
+        // receiver NACKs to the group meanwhile are left out of it
+        QTimer nackTimer;
+        QHostAddress nackAddress;    // sender of the END
+        quint16 nackPort = 0;
+        QVector<ReceivedPacketSet::Range> heardNacks;
+
+        // Restarted by every datagram of the transfer; dropTransfer on timeout
+        QTimer idleTimer;
+    };
+
+    void startTransfer(quint32 id, QDataStream &in);
+    void rejectTransfer(quint32 id, const QString &reason);
+
+    // Forgets a transfer that went quiet: saved ones once the sender has had
+    // its DONE, unfinished ones (the sender gave up) with their .part file
+    void dropTransfer(quint32 id);
+
+    // Gap report to the sender (and to the group, when multicast)
+    void sendNack(quint32 id);
+
+    // Positive completion ACK for one transfer
+    void sendDone(quint32 id, const QHostAddress &address, quint16 port);
+
     Ui::MainWindow *ui;
 
     QUdpSocket *udpSocket;
+    QHostAddress multicastGroup;     // null unless a group was joined
+    quint16 serverPort;
+
+    // Keyed by transfer id; finished transfers stay (file closed, bitmap freed)
+    // until they go quiet, so a repeated END is still answered with DONE
+    QMap<quint32, IncomingTransfer *> transfers;
 
-    QString fileName;
-    qint64 fileSize;
-    int totalPackets;
-    int receivedPackets;
+    // Ids whose META was rejected: the sender repeats it every round, but it
+    // is logged once (forgotten after the same idle time as a transfer)
+    QSet<quint32> rejectedIds;
 
-    QFile file;
-    QMap<int, QByteArray> packetBuffer;
+    DatagramCipher cipher;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,116 @@
+#include "receivedpacketset.h"
+#include <QtAlgorithms>
+#include <new>
+#include <stdexcept>
+
+ReceivedPacketSet::ReceivedPacketSet()
+    : total(0), received(0), firstMissingWord(0)
+{
+}
+
+bool ReceivedPacketSet::reset(qint64 totalPackets)
+{
+    total = 0;
+    received = 0;
+    firstMissingWord = 0;
+    words.clear();
+
+    if(totalPackets < 0)
+        return false;
+
+    try
+    {
+        words.assign(size_t((totalPackets + 63) / 64), 0);
+    }
+    catch(const std::bad_alloc &)
+    {
+        return false;
+    }
+    catch(const std::length_error &)
+    {
+        return false;
+    }
+
+    total = totalPackets;
+    return true;
+}
+
+bool ReceivedPacketSet::insert(qint64 packetNo)
+{
+    if(packetNo < 0 || packetNo >= total)
+        return false;
+
+    quint64 &word = words[size_t(packetNo >> 6)];
+    const quint64 bit = quint64(1) << (packetNo & 63);
+
+    if(word & bit)
+        return false;
+
+    word |= bit;
+    received++;
+    return true;
+}
+
+bool ReceivedPacketSet::contains(qint64 packetNo) const
+{
+    if(packetNo < 0 || packetNo >= total)
+        return false;
+
+    return words[size_t(packetNo >> 6)] & (quint64(1) << (packetNo & 63));
+}
+
+qint64 ReceivedPacketSet::firstMissing() const
+{
+    const qint64 wordCount = qint64(words.size());
+
+    while(firstMissingWord < wordCount && words[size_t(firstMissingWord)] == ~quint64(0))
+        firstMissingWord++;
+
+    if(firstMissingWord == wordCount)
+        return total;
+
+    const qint64 packetNo = firstMissingWord * 64 + qCountTrailingZeroBits(~words[size_t(firstMissingWord)]);
+    return qMin(packetNo, total);
+}
+
+QVector<ReceivedPacketSet::Range> ReceivedPacketSet::missingRanges(int maxRanges) const
+{
+    QVector<Range> ranges;
+
+    qint64 packetNo = firstMissing();
+
+    while(packetNo < total)
+    {
+        // Find the end of this gap: next set bit
+        const qint64 wordCount = qint64(words.size());
+        qint64 wordIndex = packetNo >> 6;
+        quint64 word = words[size_t(wordIndex)] & (~quint64(0) << (packetNo & 63));
+
+        while(word == 0 && ++wordIndex < wordCount)
+            word = words[size_t(wordIndex)];
+
+        const qint64 gapEnd = (word == 0) ? total
+                                          : qMin(total, wordIndex * 64 + qCountTrailingZeroBits(word));
+
+        ranges.append(Range(packetNo, gapEnd - 1));
+
+        if(maxRanges > 0 && ranges.size() >= maxRanges)
+            break;
+
+        // Find the start of the next gap: next clear bit
+        packetNo = gapEnd;
+        if(packetNo >= total)
+            break;
+
+        wordIndex = packetNo >> 6;
+        word = ~words[size_t(wordIndex)] & (~quint64(0) << (packetNo & 63));
+
+        while(word == 0 && ++wordIndex < wordCount)
+            word = ~words[size_t(wordIndex)];
+
+        packetNo = (word == 0) ? total
+                               : qMin(total, wordIndex * 64 + qCountTrailingZeroBits(word));
+    }
+
+    return ranges;
+}
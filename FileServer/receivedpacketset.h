@@ -0,0 +1,45 @@
+#ifndef RECEIVEDPACKETSET_H
+#define RECEIVEDPACKETSET_H
+
+#include <QVector>
+#include <vector>
+#include <QPair>
+#include <QtGlobal>
+
+// Compact bitmap of received packet numbers.
+// One bit per packet, so duplicate checks are O(1) and a million packets
+// fit in 128 KB. Also answers "first missing" / "missing ranges" for NACKs.
+class ReceivedPacketSet
+{
+public:
+    typedef QPair<qint64, qint64> Range;   // inclusive [first, last]
+
+    ReceivedPacketSet();
+
+    // False (and an empty set) if totalPackets is negative or its bitmap
+    // cannot be allocated; totalPackets comes straight off the network
+    bool reset(qint64 totalPackets);
+
+    // Marks packetNo as received; returns false for duplicates / out of range
+    bool insert(qint64 packetNo);
+    bool contains(qint64 packetNo) const;
+
+    qint64 size() const { return total; }
+    qint64 receivedCount() const { return received; }
+    bool isComplete() const { return received == total; }
+
+    // First packet not yet received, or size() when complete
+    qint64 firstMissing() const;
+
+    // Gaps in ascending order, at most maxRanges of them (0 = no limit)
+    QVector<Range> missingRanges(int maxRanges = 0) const;
+
+private:
+    // std::vector: 64-bit sizes with Qt 5 too (QVector is int-indexed there)
+    std::vector<quint64> words;
+    qint64 total;
+    qint64 received;
+    mutable qint64 firstMissingWord;   // every word before this one is full
+};
+
+#endif // RECEIVEDPACKETSET_H
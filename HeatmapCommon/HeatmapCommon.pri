@@ -0,0 +1,47 @@
+# Shared code for the heatmap viewers (SquareMatrix / Polar_Matrix / 2D_Matrix).
+# Include from a .pro file with: include(../HeatmapCommon/HeatmapCommon.pri)
+
+QT += concurrent
+
+# QOpenGLWidget / QOpenGLTexture moved out of widgets / gui in Qt 6
+greaterThan(QT_MAJOR_VERSION, 5): QT += opengl openglwidgets
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/cellpicker.cpp \
+    $$PWD/colorkernel.cpp \
+    $$PWD/colorlut.cpp \
+    $$PWD/csvimporter.cpp \
+    $$PWD/downsampler.cpp \
+    $$PWD/frameprefetcher.cpp \
+    $$PWD/glheatmaprenderer.cpp \
+    $$PWD/gridgenerator.cpp \
+    $$PWD/gridstats.cpp \
+    $$PWD/heatmapfeed.cpp \
+    $$PWD/heatmaprenderer.cpp \
+    $$PWD/hoveroverlay.cpp \
+    $$PWD/matrixfile.cpp \
+    $$PWD/polarmap.cpp \
+    $$PWD/tilepyramid.cpp
+
+HEADERS += \
+    $$PWD/cellpicker.h \
+    $$PWD/colorkernel.h \
+    $$PWD/colorlut.h \
+    $$PWD/csvimporter.h \
+    $$PWD/densegrid.h \
+    $$PWD/downsampler.h \
+    $$PWD/frameprefetcher.h \
+    $$PWD/glheatmaprenderer.h \
+    $$PWD/gridcolorizer.h \
+    $$PWD/gridgenerator.h \
+    $$PWD/gridstats.h \
+    $$PWD/heatmapfeed.h \
+    $$PWD/heatmaprenderer.h \
+    $$PWD/hoveroverlay.h \
+    $$PWD/matrixfile.h \
+    $$PWD/nodata.h \
+    $$PWD/polarmap.h \
+    $$PWD/rowbands.h \
+    $$PWD/tilepyramid.h
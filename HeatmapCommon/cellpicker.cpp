@@ -0,0 +1,69 @@
+#include "cellpicker.h"
+#include <cmath>
+
+CellPicker::CellPicker()
+    : nRows(0), nCols(0), bottomUp(false)
+{
+}
+
+void CellPicker::setGridSize(int rows, int cols)
+{
+    nRows = rows;
+    nCols = cols;
+}
+
+void CellPicker::setView(const QRectF &cells, const QRectF &screen)
+{
+    cellArea = cells;
+    screenArea = screen;
+}
+
+void CellPicker::setRowsBottomUp(bool rowsBottomUp)
+{
+    bottomUp = rowsBottomUp;
+}
+
+QPointF CellPicker::screenToCell(const QPointF &pos) const
+{
+    if (screenArea.isEmpty())
+        return QPointF();
+
+    const double x = cellArea.left() + (pos.x() - screenArea.left()) * cellArea.width() / screenArea.width();
+    const double y = cellArea.top() + (pos.y() - screenArea.top()) * cellArea.height() / screenArea.height();
+
+    // y is a display row; bottom-up grids count rows from the other end
+    return QPointF(x, bottomUp ? nRows - y : y);
+}
+
+QRectF CellPicker::cellToScreen(int row, int col) const
+{
+    if (cellArea.isEmpty())
+        return QRectF();
+
+    const double sx = screenArea.width() / cellArea.width();
+    const double sy = screenArea.height() / cellArea.height();
+    const int displayRow = bottomUp ? nRows - 1 - row : row;
+
+    return QRectF(screenArea.left() + (col - cellArea.left()) * sx,
+                  screenArea.top() + (displayRow - cellArea.top()) * sy, sx, sy);
+}
+
+bool CellPicker::cellAt(const QPointF &pos, int *row, int *col) const
+{
+    if (screenArea.isEmpty() || cellArea.isEmpty())
+        return false;
+
+    const double x = cellArea.left() + (pos.x() - screenArea.left()) * cellArea.width() / screenArea.width();
+    const double y = cellArea.top() + (pos.y() - screenArea.top()) * cellArea.height() / screenArea.height();
+
+    const int j = int(std::floor(x));
+    const int displayRow = int(std::floor(y));
+    const int i = bottomUp ? nRows - 1 - displayRow : displayRow;
+
+    if (i < 0 || i >= nRows || j < 0 || j >= nCols)
+        return false;
+
+    *row = i;
+    *col = j;
+    return true;
+}
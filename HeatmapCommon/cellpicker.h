@@ -0,0 +1,42 @@
+#ifndef CELLPICKER_H
+#define CELLPICKER_H
+
+#include <QPointF>
+#include <QRectF>
+
+// Screen ↔ cell mapping for a grid drawn as an axis-aligned rectangle.
+//
+// setView() says which part of the grid (in cell coordinates, x = column,
+// y = row) is drawn over which screen rectangle; zoom and pan are just a
+// different cell rectangle. With rows bottom-up, row 0 is drawn at the
+// bottom of the screen rectangle.
+class CellPicker
+{
+public:
+    CellPicker();
+
+    void setGridSize(int rows, int cols);
+    void setView(const QRectF &cells, const QRectF &screen);
+    void setRowsBottomUp(bool bottomUp);
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+
+    // Fractional cell coordinates under pos (x = column, y = row)
+    QPointF screenToCell(const QPointF &pos) const;
+
+    // Screen rectangle of one cell
+    QRectF cellToScreen(int row, int col) const;
+
+    // Cell under pos; false when pos is off the grid
+    bool cellAt(const QPointF &pos, int *row, int *col) const;
+
+private:
+    int nRows;
+    int nCols;
+    QRectF cellArea;
+    QRectF screenArea;
+    bool bottomUp;
+};
+
+#endif // CELLPICKER_H
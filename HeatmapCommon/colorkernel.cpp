@@ -0,0 +1,135 @@
+#include "colorkernel.h"
+#include "nodata.h"
+#include <QtGlobal>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define COLORKERNEL_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*RowFunction)(const int *, int, int, float, const QRgb *, int, QRgb *);
+
+void colorizeScalar(const int *values, int count, int minVal, float scale,
+                    const QRgb *lut, int lutSize, QRgb *out)
+{
+    const float low = float(minVal);
+    const float last = float(lutSize - 1);
+
+    for (int j = 0; j < count; ++j) {
+        const float x = (float(values[j]) - low) * scale + 0.5f;
+        out[j] = values[j] == NoDataValue ? NoDataColor : lut[int(qBound(0.0f, x, last))];
+    }
+}
+
+#ifdef COLORKERNEL_X86
+
+__attribute__((target("sse4.1")))
+void colorizeSse41(const int *values, int count, int minVal, float scale,
+                   const QRgb *lut, int lutSize, QRgb *out)
+{
+    const __m128 vMin = _mm_set1_ps(float(minVal));
+    const __m128 vScale = _mm_set1_ps(scale);
+    const __m128 vHalf = _mm_set1_ps(0.5f);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vLast = _mm_set1_ps(float(lutSize - 1));
+    const __m128i vNoData = _mm_set1_epi32(NoDataValue);
+    const __m128i vNoDataColor = _mm_set1_epi32(int(NoDataColor));
+
+    alignas(16) int index[4];
+    int j = 0;
+
+    for (; j + 4 <= count; j += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + j));
+        __m128 f = _mm_sub_ps(_mm_cvtepi32_ps(v), vMin);
+        __m128 x = _mm_add_ps(_mm_mul_ps(f, vScale), vHalf);
+        __m128i idx = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(x, vZero), vLast));
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(index), idx);
+        __m128i colors = _mm_setr_epi32(int(lut[index[0]]), int(lut[index[1]]),
+                                        int(lut[index[2]]), int(lut[index[3]]));
+        colors = _mm_blendv_epi8(colors, vNoDataColor, _mm_cmpeq_epi32(v, vNoData));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + j), colors);
+    }
+
+    colorizeScalar(values + j, count - j, minVal, scale, lut, lutSize, out + j);
+}
+
+__attribute__((target("avx2")))
+void colorizeAvx2(const int *values, int count, int minVal, float scale,
+                  const QRgb *lut, int lutSize, QRgb *out)
+{
+    const __m256 vMin = _mm256_set1_ps(float(minVal));
+    const __m256 vScale = _mm256_set1_ps(scale);
+    const __m256 vHalf = _mm256_set1_ps(0.5f);
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 vLast = _mm256_set1_ps(float(lutSize - 1));
+    const __m256i vNoData = _mm256_set1_epi32(NoDataValue);
+    const __m256i vNoDataColor = _mm256_set1_epi32(int(NoDataColor));
+    const int *table = reinterpret_cast<const int *>(lut);
+
+    int j = 0;
+
+    for (; j + 8 <= count; j += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + j));
+        __m256 f = _mm256_sub_ps(_mm256_cvtepi32_ps(v), vMin);
+        __m256 x = _mm256_add_ps(_mm256_mul_ps(f, vScale), vHalf);
+        __m256i idx = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(x, vZero), vLast));
+
+        __m256i colors = _mm256_i32gather_epi32(table, idx, 4);
+        colors = _mm256_blendv_epi8(colors, vNoDataColor, _mm256_cmpeq_epi32(v, vNoData));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j), colors);
+    }
+
+    colorizeScalar(values + j, count - j, minVal, scale, lut, lutSize, out + j);
+}
+
+#endif // COLORKERNEL_X86
+
+struct Dispatch
+{
+    Dispatch() : function(colorizeScalar), name("scalar")
+    {
+#ifdef COLORKERNEL_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2")) {
+            function = colorizeAvx2;
+            name = "avx2";
+        } else if (__builtin_cpu_supports("sse4.1")) {
+            function = colorizeSse41;
+            name = "sse4.1";
+        }
+#endif
+    }
+
+    RowFunction function;
+    const char *name;
+};
+
+const Dispatch &dispatch()
+{
+    static const Dispatch selected;
+    return selected;
+}
+
+} // namespace
+
+void ColorKernel::colorizeRow(const int *values, int count, int minVal, float scale,
+                              const QRgb *lut, int lutSize, QRgb *out)
+{
+    // A degenerate range (e.g. a bad file header) can give an infinite or NaN
+    // scale, and 0 × inf is NaN, which the SIMD clamps and qBound map to
+    // opposite ends. Zero instead: every cell gets the first colour
+    if (!std::isfinite(scale))
+        scale = 0.0f;
+
+    dispatch().function(values, count, minVal, scale, lut, lutSize, out);
+}
+
+const char *ColorKernel::implementationName()
+{
+    return dispatch().name;
+}
@@ -0,0 +1,127 @@
+#include "colorlut.h"
+#include <QFile>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+// Normalised value (0.0 → 1.0) → colour of the default ramp
+QColor rampColor(double value)
+{
+    // Clamp the value between 0 and 1 (safety check)
+    value = std::max(0.0, std::min(1.0, value));
+
+    // Different color ranges depending on the normalized value
+    if (value < 0.125) { // Very low values → Light Green to Green
+        double t = value / 0.125;
+        return QColor(144 - t*44, 238 - t*83, 144 - t*44);
+    } else if (value < 0.25) { // Green → Dark Green
+        double t = (value - 0.125) / 0.125;
+        return QColor(100 - t*50, 155 - t*55, 100 - t*50);
+    } else if (value < 0.375) { // Dark Green → Light Yellow
+        double t = (value - 0.25) / 0.125;
+        return QColor(50 + t*205, 100 + t*155, 50);
+    } else if (value < 0.5) { // Light Yellow → Yellow
+        double t = (value - 0.375) / 0.125;
+        return QColor(255, 255 - t*55, 50 + t*205);
+    } else if (value < 0.625) { // Yellow → Orange
+        double t = (value - 0.5) / 0.125;
+        return QColor(255, 255 - t*127, 0);
+    } else if (value < 0.75) { // Orange → Light Red
+        double t = (value - 0.625) / 0.125;
+        return QColor(255, 128 - t*50, 0 + t*128);
+    } else if (value < 0.875) { // Light Red → Red
+        double t = (value - 0.75) / 0.125;
+        return QColor(255, 78 - t*78, 128 - t*128);
+    } else { // Red → Dark Red (highest values)
+        double t = (value - 0.875) / 0.125;
+        return QColor(255 - t*100, 0, 0);
+    }
+}
+}
+
+ColorLut::ColorLut()
+{
+}
+
+ColorLut ColorLut::defaultRamp(int size)
+{
+    return fromFunction(rampColor, size);
+}
+
+ColorLut ColorLut::fromStops(const QGradientStops &stops, int size)
+{
+    QGradientStops sorted = stops;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const QGradientStop &a, const QGradientStop &b) { return a.first < b.first; });
+
+    if (sorted.isEmpty())
+        sorted << QGradientStop(0.0, Qt::black) << QGradientStop(1.0, Qt::white);
+
+    return fromFunction([&sorted](double value) {
+        if (value <= sorted.first().first)
+            return sorted.first().second;
+        if (value >= sorted.last().first)
+            return sorted.last().second;
+
+        // First stop at or after value; its predecessor starts the segment
+        int k = 1;
+        while (sorted.at(k).first < value)
+            ++k;
+
+        const QGradientStop &a = sorted.at(k - 1);
+        const QGradientStop &b = sorted.at(k);
+        const double span = b.first - a.first;
+        const double t = span > 0.0 ? (value - a.first) / span : 0.0;
+
+        return QColor::fromRgbF(a.second.redF() + t * (b.second.redF() - a.second.redF()),
+                                a.second.greenF() + t * (b.second.greenF() - a.second.greenF()),
+                                a.second.blueF() + t * (b.second.blueF() - a.second.blueF()));
+    }, size);
+}
+
+ColorLut ColorLut::fromFile(const QString &path, bool *ok, int size)
+{
+    if (ok)
+        *ok = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return ColorLut();
+
+    QGradientStops stops;
+    QTextStream in(&file);
+
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const QStringList parts = line.split(QRegularExpression("[\\s,;]+"), Qt::SkipEmptyParts);
+
+        bool posOk = false;
+        const double position = parts.value(0).toDouble(&posOk);
+        if (!posOk)
+            return ColorLut();
+
+        QColor color;
+        if (parts.size() == 2) {
+            color = QColor(parts.at(1));                     // "#rrggbb" or SVG colour name
+        } else if (parts.size() >= 4) {
+            color = QColor(parts.at(1).toInt(), parts.at(2).toInt(), parts.at(3).toInt());
+        }
+
+        if (!color.isValid())
+            return ColorLut();
+
+        stops << QGradientStop(qBound(0.0, position, 1.0), color);
+    }
+
+    if (stops.size() < 2)
+        return ColorLut();
+
+    if (ok)
+        *ok = true;
+
+    return fromStops(stops, size);
+}
@@ -0,0 +1,60 @@
+#ifndef COLORLUT_H
+#define COLORLUT_H
+
+#include <QColor>
+#include <QGradientStops>
+#include <QRgb>
+#include <QString>
+#include <QVector>
+
+// Colour ramp baked into a table of QRgb values.
+// Index = normalised value (0.0–1.0) quantised to size()-1 steps, so
+// colouring a cell is one multiply and one load instead of a branchy
+// ramp evaluation plus a QColor round trip.
+class ColorLut
+{
+public:
+    enum { DefaultSize = 4096 };
+
+    ColorLut();
+
+    // Samples any "normalised value -> QColor" function at every entry
+    template <typename ColorFunction>
+    static ColorLut fromFunction(ColorFunction colorAt, int size = DefaultSize)
+    {
+        ColorLut lut;
+        lut.entries.resize(qMax(2, size));
+
+        const int last = lut.entries.size() - 1;
+        for (int i = 0; i <= last; ++i)
+            lut.entries[i] = colorAt(double(i) / last).rgb();
+
+        return lut;
+    }
+
+    // The viewers' ramp: light green → green → yellow → orange → red → dark red
+    static ColorLut defaultRamp(int size = DefaultSize);
+
+    // Linear interpolation between gradient stops (positions 0.0–1.0)
+    static ColorLut fromStops(const QGradientStops &stops, int size = DefaultSize);
+
+    // Custom ramp file: one stop per line, "position r g b" or "position #rrggbb",
+    // blank lines and lines starting with '#' are ignored
+    static ColorLut fromFile(const QString &path, bool *ok = nullptr, int size = DefaultSize);
+
+    bool isEmpty() const { return entries.isEmpty(); }
+    int size() const { return entries.size(); }
+    const QRgb *table() const { return entries.constData(); }
+
+    QRgb at(int index) const { return entries.at(qBound(0, index, entries.size() - 1)); }
+
+    QRgb lookup(double normalized) const
+    {
+        return at(int(normalized * (entries.size() - 1) + 0.5));
+    }
+
+private:
+    QVector<QRgb> entries;
+};
+
+#endif // COLORLUT_H
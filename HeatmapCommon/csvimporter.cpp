@@ -0,0 +1,248 @@
+#include "csvimporter.h"
+#include "nodata.h"
+#include <QFile>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+struct Chunk
+{
+    const char *begin;
+    const char *end;       // just after a '\n' (or end of file)
+    qint64 firstRow;       // set from the row counts of the chunks before it
+    qint64 rowCount;
+    qint64 badRow;         // first row with the wrong number of values, -1 if none
+    int badCount;
+};
+
+bool fail(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+    return false;
+}
+
+inline bool isSeparator(char c)
+{
+    return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\r';
+}
+
+// ',' and ';' end a field (two in a row leave an empty cell); spaces only pad
+inline bool isDelimiter(char c)
+{
+    return c == ',' || c == ';';
+}
+
+inline const char *lineEnd(const char *p, const char *end)
+{
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+    return nl ? nl : end;
+}
+
+inline const char *nextLine(const char *p, const char *end)
+{
+    const char *e = lineEnd(p, end);
+    return e < end ? e + 1 : end;
+}
+
+inline bool isBlank(const char *p, const char *e)
+{
+    while (p < e && isSeparator(*p))
+        ++p;
+    return p == e;
+}
+
+// One value at p; returns the position after it, nullptr if there is none.
+// "nan" is no data; real values are clamped to [INT_MIN + 1, INT_MAX], so
+// none of them turns into NoDataValue (INT_MIN)
+inline const char *parseValue(const char *p, const char *e, int &value)
+{
+    if (*p == '+') {
+        ++p;                                   // from_chars does not take a '+'
+        if (p < e && (*p == '+' || *p == '-'))
+            return nullptr;                    // ... nor may a second sign follow
+    }
+
+    const int lowest = std::numeric_limits<int>::min() + 1;
+
+    // Fast path: plain integer
+    std::from_chars_result r = std::from_chars(p, e, value);
+    if (r.ec == std::errc() && (r.ptr == e || (*r.ptr != '.' && *r.ptr != 'e' && *r.ptr != 'E'))) {
+        value = qMax(value, lowest);
+        return r.ptr;
+    }
+
+    // Fraction, exponent, out of int range or nan / inf: parse as double,
+    // round and clamp
+    double d = 0.0;
+    r = std::from_chars(p, e, d);
+    if (r.ec != std::errc())
+        return nullptr;
+
+    if (std::isnan(d)) {
+        value = NoDataValue;
+        return r.ptr;
+    }
+
+    d = std::round(d);
+    d = qBound(double(lowest), d, double(std::numeric_limits<int>::max()));
+    value = int(d);
+    return r.ptr;
+}
+
+// Values on line [p, e) go to out[0 .. cols); returns how many values the
+// line holds, -1 if it contains something that is not a number. An empty
+// field between delimiters (or before the first / after the last) is a
+// NoDataValue cell
+int parseLine(const char *p, const char *e, int *out, int cols)
+{
+    int n = 0;
+    bool fieldOpen = true;                     // no value since the last delimiter
+    bool delimited = false;                    // the line has delimiters at all
+
+    for (;;) {
+        while (p < e && isSeparator(*p) && !isDelimiter(*p))
+            ++p;
+
+        if (p == e || isDelimiter(*p)) {
+            if (fieldOpen && (p < e || delimited)) {
+                if (n < cols)
+                    out[n] = NoDataValue;
+                ++n;
+            }
+            if (p == e)
+                return n;
+
+            fieldOpen = true;
+            delimited = true;
+            ++p;
+            continue;
+        }
+
+        int value;
+        const char *next = parseValue(p, e, value);
+        if (!next || (next < e && !isSeparator(*next)))
+            return -1;
+
+        if (n < cols)
+            out[n] = value;
+        ++n;
+        fieldOpen = false;
+        p = next;
+    }
+}
+
+} // namespace
+
+bool CsvImporter::import(const QString &path, DenseGrid<int> &grid, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(error, file.errorString());
+
+    const qint64 size = file.size();
+    if (size == 0)
+        return fail(error, "File is empty");
+
+    // Map the whole file; read it only if mapping is not possible (e.g. a pipe)
+    QByteArray fallback;
+    qint64 length = size;
+    const char *data = reinterpret_cast<const char *>(file.map(0, size));
+    if (!data) {
+        fallback = file.readAll();
+        data = fallback.constData();
+        length = fallback.size();
+    }
+    const char *end = data + length;
+
+    // Leading blank lines and an optional header line
+    const char *p = data;
+    while (p < end && isBlank(p, lineEnd(p, end)))
+        p = nextLine(p, end);
+
+    if (p < end) {
+        const char *c = p;
+        while (isSeparator(*c))
+            ++c;
+        if (!((*c >= '0' && *c <= '9') || *c == '-' || *c == '+' || *c == '.')
+            && parseLine(p, lineEnd(p, end), nullptr, 0) < 0)
+            p = nextLine(p, end);           // (a row starting with "nan" is data)
+    }
+
+    while (p < end && isBlank(p, lineEnd(p, end)))
+        p = nextLine(p, end);
+
+    if (p == end)
+        return fail(error, "No numeric rows found");
+
+    // Column count from the first data row
+    const int cols = parseLine(p, lineEnd(p, end), nullptr, 0);
+    if (cols <= 0)
+        return fail(error, "First data row does not hold numbers");
+
+    // Chunks of about ChunkBytes, each ending on a line boundary
+    QVector<Chunk> chunks;
+    for (const char *c = p; c < end;) {
+        const char *ce = end - c > ChunkBytes ? nextLine(c + ChunkBytes, end) : end;
+        chunks.append(Chunk{ c, ce, 0, 0, -1, 0 });
+        c = ce;
+    }
+
+    // Pass 1: rows per chunk
+    QtConcurrent::blockingMap(chunks, [](Chunk &chunk) {
+        for (const char *l = chunk.begin; l < chunk.end; l = nextLine(l, chunk.end)) {
+            if (!isBlank(l, lineEnd(l, chunk.end)))
+                ++chunk.rowCount;
+        }
+    });
+
+    qint64 rows = 0;
+    for (Chunk &chunk : chunks) {
+        chunk.firstRow = rows;
+        rows += chunk.rowCount;
+    }
+
+    if (rows > std::numeric_limits<int>::max())
+        return fail(error, "Too many rows");
+
+    // Pass 2: parse every chunk straight into its rows
+    DenseGrid<int> parsed(int(rows), cols);
+
+    QtConcurrent::blockingMap(chunks, [&parsed, cols](Chunk &chunk) {
+        qint64 row = chunk.firstRow;
+
+        for (const char *l = chunk.begin; l < chunk.end; l = nextLine(l, chunk.end)) {
+            const char *e = lineEnd(l, chunk.end);
+            if (isBlank(l, e))
+                continue;
+
+            const int count = parseLine(l, e, parsed.row(int(row)), cols);
+            if (count != cols) {
+                chunk.badRow = row;
+                chunk.badCount = count;
+                return;
+            }
+            ++row;
+        }
+    });
+
+    // Earliest bad row wins
+    for (const Chunk &chunk : chunks) {
+        if (chunk.badRow < 0)
+            continue;
+
+        if (chunk.badCount < 0)
+            return fail(error, QString("Row %1 contains a value that is not a number").arg(chunk.badRow + 1));
+
+        return fail(error, QString("Row %1 has %2 values, expected %3")
+                               .arg(chunk.badRow + 1).arg(chunk.badCount).arg(cols));
+    }
+
+    grid = std::move(parsed);
+    return true;
+}
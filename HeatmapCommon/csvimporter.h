@@ -0,0 +1,28 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <QString>
+#include "densegrid.h"
+
+// Imports a text matrix (CSV / TSV / whitespace separated, one grid row per
+// line) into a DenseGrid<int>.
+//
+// The file is memory-mapped and cut into chunks at line boundaries. One
+// parallel pass counts the rows in every chunk, which gives each chunk its
+// first row; a second parallel pass parses the chunks straight into their
+// rows with std::from_chars. No per-line strings, no locale, no copies.
+//
+// Separators are any mix of ',', ';', spaces and tabs; blank lines are
+// skipped, a first line that does not start with a number is taken as a
+// header and skipped. Values with a fraction or exponent are rounded and
+// clamped to [INT_MIN + 1, INT_MAX]; "nan" and empty fields (nothing
+// between two ',' / ';') become NoDataValue.
+class CsvImporter
+{
+public:
+    enum { ChunkBytes = 4 << 20 };
+
+    static bool import(const QString &path, DenseGrid<int> &grid, QString *error = nullptr);
+};
+
+#endif // CSVIMPORTER_H
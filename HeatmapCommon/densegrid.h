@@ -0,0 +1,182 @@
+#ifndef DENSEGRID_H
+#define DENSEGRID_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Row view into a DenseGrid: pointer + length, usable in range-for
+template <typename T>
+class GridRow
+{
+public:
+    GridRow(T *data, int size) : ptr(data), len(size) {}
+
+    T *data() const { return ptr; }
+    int size() const { return len; }
+
+    T &operator[](int col) const { return ptr[col]; }
+
+    T *begin() const { return ptr; }
+    T *end() const { return ptr + len; }
+
+private:
+    T *ptr;
+    int len;
+};
+
+// Dense 2D grid stored row-major in one 64-byte aligned buffer.
+// Rows are padded to a multiple of 64 bytes (stride), so every row starts
+// on a cache line / SIMD boundary. One allocation for the whole grid,
+// no per-row heap blocks and no implicit-sharing checks on access.
+// wrap() makes a non-owning grid over existing memory (e.g. a mapped file);
+// copying it or calling resize() gives an owning grid again.
+template <typename T>
+class DenseGrid
+{
+    static_assert(std::is_trivially_copyable<T>::value, "DenseGrid holds plain numeric cells");
+
+public:
+    enum { Alignment = 64 };
+
+    DenseGrid() : buffer(nullptr), nRows(0), nCols(0), rowStride(0), owner(true) {}
+
+    DenseGrid(int rows, int cols, T value = T())
+        : DenseGrid()
+    {
+        resize(rows, cols, value);
+    }
+
+    DenseGrid(const DenseGrid &other)
+        : DenseGrid()
+    {
+        *this = other;
+    }
+
+    DenseGrid(DenseGrid &&other) noexcept
+        : DenseGrid()
+    {
+        swap(other);
+    }
+
+    ~DenseGrid() { release(); }
+
+    // Non-owning grid over rows x cols cells, stride elements between row starts.
+    // The memory must outlive the grid.
+    static DenseGrid wrap(T *data, int rows, int cols, qsizetype stride)
+    {
+        DenseGrid grid;
+        grid.buffer = data;
+        grid.nRows = qMax(0, rows);
+        grid.nCols = qMax(0, cols);
+        grid.rowStride = stride;
+        grid.owner = false;
+        return grid;
+    }
+
+    DenseGrid &operator=(const DenseGrid &other)
+    {
+        if(this != &other)
+        {
+            allocate(other.nRows, other.nCols);
+            if(buffer && rowStride == other.rowStride)
+            {
+                std::memcpy(buffer, other.buffer, byteSize());
+            }
+            else if(buffer)
+            {
+                // Wrapped source with a different row padding
+                for(int i = 0; i < nRows; ++i)
+                    std::memcpy(row(i), other.row(i), size_t(nCols) * sizeof(T));
+            }
+        }
+        return *this;
+    }
+
+    DenseGrid &operator=(DenseGrid &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(DenseGrid &other) noexcept
+    {
+        std::swap(buffer, other.buffer);
+        std::swap(nRows, other.nRows);
+        std::swap(nCols, other.nCols);
+        std::swap(rowStride, other.rowStride);
+        std::swap(owner, other.owner);
+    }
+
+    // Reallocates; previous contents are discarded
+    void resize(int rows, int cols, T value = T())
+    {
+        allocate(rows, cols);
+        fill(value);
+    }
+
+    void fill(T value)
+    {
+        for(int i = 0; i < nRows; ++i)
+            std::fill(row(i), row(i) + nCols, value);
+    }
+
+    int rows() const { return nRows; }
+    int cols() const { return nCols; }
+    qsizetype stride() const { return rowStride; }      // elements between row starts
+    qsizetype cellCount() const { return qsizetype(nRows) * nCols; }
+    bool isEmpty() const { return nRows == 0 || nCols == 0; }
+    bool ownsData() const { return owner; }
+
+    T *data() { return buffer; }
+    const T *data() const { return buffer; }
+
+    T *row(int i) { return buffer + i * rowStride; }
+    const T *row(int i) const { return buffer + i * rowStride; }
+
+    GridRow<T> rowView(int i) { return GridRow<T>(row(i), nCols); }
+    GridRow<const T> rowView(int i) const { return GridRow<const T>(row(i), nCols); }
+
+    T &at(int i, int j) { return buffer[i * rowStride + j]; }
+    const T &at(int i, int j) const { return buffer[i * rowStride + j]; }
+
+    bool contains(int i, int j) const { return i >= 0 && i < nRows && j >= 0 && j < nCols; }
+
+private:
+    qsizetype byteSize() const { return qsizetype(nRows) * rowStride * qsizetype(sizeof(T)); }
+
+    void allocate(int rows, int cols)
+    {
+        release();
+
+        nRows = qMax(0, rows);
+        nCols = qMax(0, cols);
+
+        const qsizetype perLine = qMax<qsizetype>(1, Alignment / qsizetype(sizeof(T)));
+        rowStride = (qsizetype(nCols) + perLine - 1) / perLine * perLine;
+
+        if(byteSize() > 0)
+            buffer = static_cast<T *>(::operator new(size_t(byteSize()), std::align_val_t(Alignment)));
+    }
+
+    void release()
+    {
+        if(buffer && owner)
+            ::operator delete(buffer, std::align_val_t(Alignment));
+
+        buffer = nullptr;
+        nRows = nCols = 0;
+        rowStride = 0;
+        owner = true;
+    }
+
+    T *buffer;
+    int nRows;
+    int nCols;
+    qsizetype rowStride;
+    bool owner;
+};
+
+#endif // DENSEGRID_H
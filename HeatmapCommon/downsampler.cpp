@@ -0,0 +1,136 @@
+#include "downsampler.h"
+#include "nodata.h"
+#include "rowbands.h"
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+// Output cell k of n covers source indices [edges[k], edges[k + 1]); n <= size,
+// so no span is empty
+QVector<int> spanEdges(int size, int n)
+{
+    QVector<int> edges(n + 1);
+    for (int k = 0; k <= n; ++k)
+        edges[k] = int(qint64(k) * size / n);
+    return edges;
+}
+
+// Min or max (op) of every block; op skips no-data cells
+template <typename T, typename Op>
+void foldExtreme(const DenseGrid<T> &source, const QVector<int> &rowEdges, const QVector<int> &colEdges,
+                 DenseGrid<T> &out, Op op)
+{
+    const int cols = source.cols();
+
+    forEachRowBand(out.rows(), [&](int first, int end, int) {
+        QVector<T> acc(cols);
+
+        for (int r = first; r < end; ++r) {
+            // Vertical: fold the block's source rows element-wise
+            T *a = acc.data();
+            std::copy_n(source.row(rowEdges[r]), cols, a);
+
+            for (int i = rowEdges[r] + 1; i < rowEdges[r + 1]; ++i) {
+                const T *row = source.row(i);
+                for (int j = 0; j < cols; ++j)
+                    a[j] = op(a[j], row[j]);
+            }
+
+            // Horizontal: fold each column span of the folded row
+            T *o = out.row(r);
+            for (int c = 0; c < out.cols(); ++c) {
+                T v = a[colEdges[c]];
+                for (int j = colEdges[c] + 1; j < colEdges[c + 1]; ++j)
+                    v = op(v, a[j]);
+                o[c] = v;
+            }
+        }
+    });
+}
+
+// Mean of every block's cells that hold data; blocks without any are no data
+template <typename T>
+void foldMean(const DenseGrid<T> &source, const QVector<int> &rowEdges, const QVector<int> &colEdges,
+              DenseGrid<T> &out)
+{
+    typedef typename std::conditional<std::is_integral<T>::value, qint64, double>::type Sum;
+    const int cols = source.cols();
+
+    forEachRowBand(out.rows(), [&](int first, int end, int) {
+        QVector<Sum> acc(cols);
+        QVector<int> valid(cols);
+
+        for (int r = first; r < end; ++r) {
+            Sum *a = acc.data();
+            int *n = valid.data();
+            std::fill_n(a, cols, Sum(0));
+            std::fill_n(n, cols, 0);
+
+            for (int i = rowEdges[r]; i < rowEdges[r + 1]; ++i) {
+                const T *row = source.row(i);
+                for (int j = 0; j < cols; ++j) {
+                    if (!isNoData(row[j])) {
+                        a[j] += row[j];
+                        ++n[j];
+                    }
+                }
+            }
+
+            T *o = out.row(r);
+
+            for (int c = 0; c < out.cols(); ++c) {
+                Sum sum = 0;
+                qint64 count = 0;
+                for (int j = colEdges[c]; j < colEdges[c + 1]; ++j) {
+                    sum += a[j];
+                    count += n[j];
+                }
+
+                if (count == 0) {
+                    o[c] = noDataOf<T>();
+                    continue;
+                }
+
+                const double mean = double(sum) / double(count);
+                o[c] = std::is_integral<T>::value ? T(std::floor(mean + 0.5)) : T(mean);
+            }
+        }
+    });
+}
+
+} // namespace
+
+template <typename T>
+DenseGrid<T> Downsampler::reduce(const DenseGrid<T> &source, int outRows, int outCols, Mode mode)
+{
+    outRows = qBound(0, outRows, source.rows());
+    outCols = qBound(0, outCols, source.cols());
+
+    DenseGrid<T> out(outRows, outCols);
+    if (out.isEmpty())
+        return out;
+
+    const QVector<int> rowEdges = spanEdges(source.rows(), outRows);
+    const QVector<int> colEdges = spanEdges(source.cols(), outCols);
+
+    if (mode == Mean)
+        foldMean(source, rowEdges, colEdges, out);
+    else if (mode == Min)
+        foldExtreme(source, rowEdges, colEdges, out, [](T a, T b) {
+            return isNoData(a) ? b : isNoData(b) ? a : std::min(a, b);
+        });
+    else
+        foldExtreme(source, rowEdges, colEdges, out, [](T a, T b) {
+            return isNoData(a) ? b : isNoData(b) ? a : std::max(a, b);
+        });
+
+    return out;
+}
+
+template DenseGrid<int> Downsampler::reduce(const DenseGrid<int> &, int, int, Mode);
+template DenseGrid<quint16> Downsampler::reduce(const DenseGrid<quint16> &, int, int, Mode);
+template DenseGrid<float> Downsampler::reduce(const DenseGrid<float> &, int, int, Mode);
+template DenseGrid<double> Downsampler::reduce(const DenseGrid<double> &, int, int, Mode);
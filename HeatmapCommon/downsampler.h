@@ -0,0 +1,29 @@
+#ifndef DOWNSAMPLER_H
+#define DOWNSAMPLER_H
+
+#include "densegrid.h"
+
+// Reduces a grid to a smaller one (e.g. screen resolution) where every
+// output cell aggregates the whole block of source cells it covers, so a
+// single peak is never dropped the way nearest sampling drops it.
+//
+// Each band of output rows first folds its source rows element-wise
+// (a straight min / max / add loop over contiguous rows, vectorised by the
+// compiler), then folds the column spans of that one row. The cost is one
+// read of every source cell; bands run in parallel.
+//
+// Instantiated for int, quint16, float and double cells. Means accumulate
+// in qint64 for integer cells (rounded back) and in double otherwise.
+// No-data cells (see nodata.h) are left out of every fold; a block with
+// nothing else is no data itself.
+class Downsampler
+{
+public:
+    enum Mode { Min, Max, Mean };
+
+    // outRows / outCols are clamped to the source size (no upsampling)
+    template <typename T>
+    static DenseGrid<T> reduce(const DenseGrid<T> &source, int outRows, int outCols, Mode mode);
+};
+
+#endif // DOWNSAMPLER_H
@@ -0,0 +1,147 @@
+#include "frameprefetcher.h"
+#include <QThread>
+
+FramePrefetcher::FramePrefetcher(int capacity)
+    : worker(nullptr)
+    , frames(0)
+    , position(0)
+    , step(1)
+    , ringCapacity(qMax(1, capacity))
+    , generation(0)
+    , producing(false)
+    , quit(false)
+{
+    worker = QThread::create([this]() { run(); });
+    worker->start();
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    {
+        QMutexLocker locker(&mutex);
+        quit = true;
+        wake.wakeAll();
+    }
+
+    worker->wait();
+    delete worker;
+}
+
+void FramePrefetcher::setProducer(Producer source, int frameCount)
+{
+    QMutexLocker locker(&mutex);
+
+    ++generation;
+    ring.clear();
+    producer = std::move(source);
+    frames = producer ? qMax(0, frameCount) : 0;
+    position = frames > 0 ? qBound(0, position, frames - 1) : 0;
+
+    // Stopping: the old producer may still be reading the old source. A
+    // new producer reads the same source, so its late frame is just dropped
+    while (!producer && producing)
+        producerIdle.wait(&mutex);
+
+    wake.wakeAll();
+}
+
+void FramePrefetcher::setPlayback(int first, int increment)
+{
+    QMutexLocker locker(&mutex);
+    moveTo(first, increment);
+}
+
+bool FramePrefetcher::takeAndAdvance(int frame, int nextPosition, int increment, DenseGrid<int> *block)
+{
+    QMutexLocker locker(&mutex);
+
+    for (int k = 0; k < ring.size(); ++k) {
+        if (ring.at(k).frame == frame) {
+            *block = std::move(ring[k].block);
+            ring.remove(k);
+            moveTo(nextPosition, increment);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void FramePrefetcher::setReadyHandler(std::function<void(int frame)> handler)
+{
+    QMutexLocker locker(&mutex);
+    ready = std::move(handler);
+}
+
+void FramePrefetcher::moveTo(int first, int increment)
+{
+    position = first;
+    step = increment != 0 ? increment : 1;
+
+    // Frames playback no longer reaches make room for ones it will
+    for (int k = ring.size() - 1; k >= 0; --k) {
+        if (!isWanted(ring.at(k).frame))
+            ring.remove(k);
+    }
+
+    wake.wakeAll();
+}
+
+int FramePrefetcher::wantedFrame(int k) const
+{
+    const qint64 frame = (qint64(position) + qint64(k) * step) % frames;
+    return int(frame < 0 ? frame + frames : frame);
+}
+
+bool FramePrefetcher::isWanted(int frame) const
+{
+    for (int k = 0; k < wantedCount(); ++k) {
+        if (wantedFrame(k) == frame)
+            return true;
+    }
+    return false;
+}
+
+void FramePrefetcher::run()
+{
+    QMutexLocker locker(&mutex);
+
+    while (!quit) {
+        // Nearest wanted frame not held yet
+        int next = -1;
+        for (int k = 0; k < wantedCount() && next < 0; ++k) {
+            const int frame = wantedFrame(k);
+            next = frame;
+            for (const Entry &entry : ring) {
+                if (entry.frame == frame) {
+                    next = -1;
+                    break;
+                }
+            }
+        }
+
+        if (next < 0) {
+            wake.wait(&mutex);
+            continue;
+        }
+
+        // Produce without the lock: the GUI thread keeps taking frames
+        const Producer produce = producer;
+        const quint64 started = generation;
+        producing = true;
+        locker.unlock();
+
+        DenseGrid<int> block = produce(next);
+
+        locker.relock();
+        producing = false;
+        producerIdle.wakeAll();
+
+        // Source changed or playback moved on meanwhile
+        if (started == generation && isWanted(next)) {
+            ring.append(Entry{ next, std::move(block) });
+            if (ready)
+                ready(next);
+        }
+    }
+}
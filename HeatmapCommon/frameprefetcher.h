@@ -0,0 +1,83 @@
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+#include "densegrid.h"
+
+class QThread;
+
+// Bounded ring of upcoming frames for time-series playback.
+//
+// A worker thread runs the producer (typically: read one frame of a mapped
+// matrix file and reduce the visible part to screen resolution) for the
+// frames playback will show next, position, position + step, ... wrapping
+// around the end, so the GUI thread only takes finished blocks. At most
+// capacity frames are held; frames playback has moved past are dropped
+// as soon as the position changes, so seeking never waits behind them.
+// Nothing here blocks the caller except stopping (an empty producer).
+class FramePrefetcher
+{
+public:
+    typedef std::function<DenseGrid<int>(int frame)> Producer;
+
+    explicit FramePrefetcher(int capacity = 8);
+    ~FramePrefetcher();
+
+    // New producer (another view or window size): drops every held frame;
+    // a frame the old producer is still reading is discarded when done.
+    // An empty producer stops prefetching and waits for that frame, so
+    // whatever the old producer reads may be released afterwards
+    void setProducer(Producer producer, int frameCount);
+
+    // Frames wanted next: position, position + step, ... (step < 0 plays
+    // backwards, |step| > 1 skips frames)
+    void setPlayback(int position, int step);
+
+    // Moves a prefetched frame out of the ring and, in the same step, moves
+    // playback on to nextPosition (see setPlayback), so the worker never
+    // reads the taken frame again; false (nothing changed) if not ready yet
+    bool takeAndAdvance(int frame, int nextPosition, int step, DenseGrid<int> *block);
+
+    // Runs on the worker thread after each frame it adds to the ring
+    void setReadyHandler(std::function<void(int frame)> handler);
+
+    int capacity() const { return ringCapacity; }
+
+private:
+    Q_DISABLE_COPY(FramePrefetcher)
+
+    struct Entry
+    {
+        int frame;
+        DenseGrid<int> block;
+    };
+
+    void run();
+
+    // k-th frame playback will want, and whether a frame is among them
+    int wantedFrame(int k) const;
+    bool isWanted(int frame) const;
+    int wantedCount() const { return qMin(ringCapacity, frames); }
+    void moveTo(int position, int step);
+
+    mutable QMutex mutex;
+    QWaitCondition wake;          // new work for the worker
+    QWaitCondition producerIdle;  // the worker finished a frame
+    QThread *worker;
+
+    Producer producer;
+    std::function<void(int frame)> ready;
+    int frames;
+    int position;
+    int step;
+    int ringCapacity;
+    QVector<Entry> ring;
+    quint64 generation;           // bumped by setProducer: late results are discarded
+    bool producing;
+    bool quit;
+};
+
+#endif // FRAMEPREFETCHER_H
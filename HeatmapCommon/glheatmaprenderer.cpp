@@ -0,0 +1,253 @@
+#include "glheatmaprenderer.h"
+#include "nodata.h"
+#include <QColor>
+#include <QMatrix4x4>
+#include <QOpenGLPixelTransferOptions>
+#include <algorithm>
+
+namespace {
+const char *VertexShader =
+    "attribute highp vec2 position;\n"
+    "attribute highp vec2 texCoord;\n"
+    "uniform highp mat4 matrix;\n"
+    "varying highp vec2 uv;\n"
+    "void main()\n"
+    "{\n"
+    "    uv = texCoord;\n"
+    "    gl_Position = matrix * vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+// Same mapping as ColorKernel: index = clamp(round((v - low) * scale)),
+// NoDataValue cells (the only texels below LowestValue) get the no-data colour
+const char *FragmentShader =
+    "uniform sampler2D values;\n"
+    "uniform sampler2D colors;\n"
+    "uniform highp float lowestValue;\n"
+    "uniform lowp vec4 noDataColor;\n"
+    "uniform highp float low;\n"
+    "uniform highp float scale;\n"
+    "uniform highp float colorCount;\n"
+    "varying highp vec2 uv;\n"
+    "void main()\n"
+    "{\n"
+    "    highp float v = texture2D(values, uv).r;\n"
+    "    if (v < lowestValue) {\n"
+    "        gl_FragColor = noDataColor;\n"
+    "        return;\n"
+    "    }\n"
+    "    highp float index = clamp(floor((v - low) * scale + 0.5), 0.0, colorCount - 1.0);\n"
+    "    gl_FragColor = texture2D(colors, vec2((index + 0.5) / colorCount, 0.5));\n"
+    "}\n";
+
+// The float just above float(NoDataValue). Ints near INT_MIN round to
+// float(NoDataValue) too, so real values are raised to this one (an error
+// below float precision there) and only no-data texels lie under it
+const float LowestValue = -2147483520.0f;
+
+inline float texel(int z)
+{
+    return z == NoDataValue ? float(NoDataValue) : qMax(float(z), LowestValue);
+}
+}
+
+GlHeatmapRenderer::GlHeatmapRenderer(QWidget *parent)
+    : QOpenGLWidget(parent), pendingRows(0), pendingCols(0), valuesDirty(false),
+      colorsDirty(false), rangeLow(0), rangeHigh(1)
+{
+}
+
+GlHeatmapRenderer::~GlHeatmapRenderer()
+{
+    // GL objects must go while their context is current
+    makeCurrent();
+    valueTexture.reset();
+    colorTexture.reset();
+    program.reset();
+    doneCurrent();
+}
+
+void GlHeatmapRenderer::setValues(DenseGrid<int> block)
+{
+    // Floats hold every int up to 2^24 exactly, enough for heatmap values
+    pendingRows = block.rows();
+    pendingCols = block.cols();
+    pendingValues.resize(pendingRows * pendingCols);
+
+    float *out = pendingValues.data();
+    for (int i = 0; i < pendingRows; ++i) {
+        for (int z : block.rowView(i))
+            *out++ = texel(z);
+    }
+
+    valuesDirty = true;
+}
+
+void GlHeatmapRenderer::updateValues(const QPoint &at, const DenseGrid<int> &patch)
+{
+    const QRect area = QRect(at, QSize(patch.cols(), patch.rows())) & QRect(0, 0, pendingCols, pendingRows);
+    if (area.isEmpty())
+        return;
+
+    for (int i = area.top(); i <= area.bottom(); ++i) {
+        const int *in = patch.row(i - at.y()) + (area.left() - at.x());
+        float *out = pendingValues.data() + qsizetype(i) * pendingCols + area.left();
+        for (int j = 0; j < area.width(); ++j)
+            out[j] = texel(in[j]);
+    }
+
+    dirtyArea = dirtyArea.united(area);
+}
+
+void GlHeatmapRenderer::setColorLut(const ColorLut &lut)
+{
+    colors = lut;
+    colorsDirty = true;
+}
+
+void GlHeatmapRenderer::setRange(int low, int high)
+{
+    rangeLow = low;
+    rangeHigh = qMax(low + 1, high);
+}
+
+void GlHeatmapRenderer::setTarget(const QRectF &target)
+{
+    targetRect = target;
+}
+
+void GlHeatmapRenderer::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    program.reset(new QOpenGLShaderProgram);
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, VertexShader);
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, FragmentShader);
+    program->bindAttributeLocation("position", 0);
+    program->bindAttributeLocation("texCoord", 1);
+    program->link();
+
+    // New context (first show or re-parenting): everything goes up again
+    valueTexture.reset();
+    colorTexture.reset();
+    valuesDirty = !pendingValues.isEmpty();
+    colorsDirty = !colors.isEmpty();
+}
+
+void GlHeatmapRenderer::uploadValues()
+{
+    valuesDirty = false;
+    dirtyArea = QRect();
+
+    if (pendingRows == 0 || pendingCols == 0) {
+        valueTexture.reset();
+        return;
+    }
+
+    // Storage is immutable: a new block size needs a new texture
+    if (!valueTexture || valueTexture->width() != pendingCols || valueTexture->height() != pendingRows) {
+        valueTexture.reset(new QOpenGLTexture(QOpenGLTexture::Target2D));
+        valueTexture->setFormat(QOpenGLTexture::R32F);
+        valueTexture->setSize(pendingCols, pendingRows);
+        valueTexture->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+        valueTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+        valueTexture->allocateStorage(QOpenGLTexture::Red, QOpenGLTexture::Float32);
+    }
+
+    QOpenGLPixelTransferOptions options;
+    options.setAlignment(4);
+    valueTexture->setData(QOpenGLTexture::Red, QOpenGLTexture::Float32, pendingValues.constData(), &options);
+}
+
+void GlHeatmapRenderer::uploadArea()
+{
+    const QRect area = dirtyArea;
+    dirtyArea = QRect();
+
+    if (!valueTexture)
+        return;
+
+    // Rows of the sub-rectangle are pendingCols apart in pendingValues. Plain
+    // GLES2 has no GL_UNPACK_ROW_LENGTH, so they are packed tightly first
+    const float *rows = pendingValues.constData() + qsizetype(area.top()) * pendingCols + area.left();
+    QVector<float> packed;
+
+    if (area.width() != pendingCols) {
+        packed.resize(area.width() * area.height());
+        for (int i = 0; i < area.height(); ++i)
+            std::copy_n(rows + qsizetype(i) * pendingCols, area.width(), packed.data() + i * area.width());
+        rows = packed.constData();
+    }
+
+    QOpenGLPixelTransferOptions options;
+    options.setAlignment(4);
+    valueTexture->setData(area.left(), area.top(), 0, area.width(), area.height(), 1,
+                          QOpenGLTexture::Red, QOpenGLTexture::Float32, rows, &options);
+}
+
+void GlHeatmapRenderer::uploadColors()
+{
+    colorsDirty = false;
+
+    if (colors.isEmpty()) {
+        colorTexture.reset();
+        return;
+    }
+
+    const QImage strip(reinterpret_cast<const uchar *>(colors.table()), colors.size(), 1, QImage::Format_RGB32);
+
+    colorTexture.reset(new QOpenGLTexture(strip, QOpenGLTexture::DontGenerateMipMaps));
+    colorTexture->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+    colorTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+}
+
+void GlHeatmapRenderer::paintGL()
+{
+    prepareFrame();
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (valuesDirty)
+        uploadValues();
+    else if (!dirtyArea.isEmpty())
+        uploadArea();
+    if (colorsDirty)
+        uploadColors();
+
+    if (!program || !program->isLinked() || !valueTexture || !colorTexture)
+        return;
+
+    QMatrix4x4 matrix;
+    matrix.ortho(0.0f, float(width()), float(height()), 0.0f, -1.0f, 1.0f);
+
+    const GLfloat l = GLfloat(targetRect.left()), r = GLfloat(targetRect.right());
+    const GLfloat t = GLfloat(targetRect.top()), b = GLfloat(targetRect.bottom());
+    const GLfloat positions[] = { l, t, r, t, l, b, r, b };
+    const GLfloat texCoords[] = { 0, 0, 1, 0, 0, 1, 1, 1 };
+
+    program->bind();
+    program->setUniformValue("matrix", matrix);
+    program->setUniformValue("values", 0);
+    program->setUniformValue("colors", 1);
+    program->setUniformValue("low", GLfloat(rangeLow));
+    program->setUniformValue("scale", GLfloat(colors.size() - 1) / GLfloat(rangeHigh - rangeLow));
+    program->setUniformValue("colorCount", GLfloat(colors.size()));
+    program->setUniformValue("lowestValue", GLfloat(LowestValue));
+    program->setUniformValue("noDataColor", QColor(NoDataColor));
+
+    valueTexture->bind(0);
+    colorTexture->bind(1);
+
+    program->enableAttributeArray(0);
+    program->enableAttributeArray(1);
+    program->setAttributeArray(0, GL_FLOAT, positions, 2);
+    program->setAttributeArray(1, GL_FLOAT, texCoords, 2);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    program->disableAttributeArray(0);
+    program->disableAttributeArray(1);
+    colorTexture->release(1);
+    valueTexture->release(0);
+    program->release();
+}
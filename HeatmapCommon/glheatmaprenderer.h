@@ -0,0 +1,59 @@
+#ifndef GLHEATMAPRENDERER_H
+#define GLHEATMAPRENDERER_H
+
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QOpenGLWidget>
+#include <QScopedPointer>
+#include <QVector>
+#include "heatmaprenderer.h"
+
+// OpenGL backend: values live in a single-channel float texture, the palette
+// in a 1-pixel-high RGBA texture, and the fragment shader does
+// value → index → colour. Only new values cause an upload (just the
+// changed rectangle for updateValues); palette and range changes are a
+// small texture / uniform update.
+class GlHeatmapRenderer : public QOpenGLWidget, public HeatmapRenderer, protected QOpenGLFunctions
+{
+public:
+    explicit GlHeatmapRenderer(QWidget *parent = nullptr);
+    ~GlHeatmapRenderer() override;
+
+    QWidget *widget() override { return this; }
+    const char *backendName() const override { return "opengl"; }
+
+    void setValues(DenseGrid<int> block) override;
+    void updateValues(const QPoint &at, const DenseGrid<int> &patch) override;
+    void setColorLut(const ColorLut &lut) override;
+    void setRange(int low, int high) override;
+    void setTarget(const QRectF &target) override;
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    void uploadValues();
+    void uploadArea();
+    void uploadColors();
+
+    QScopedPointer<QOpenGLShaderProgram> program;
+    QScopedPointer<QOpenGLTexture> valueTexture;
+    QScopedPointer<QOpenGLTexture> colorTexture;
+
+    QVector<float> pendingValues;      // tightly packed, waiting for upload
+    int pendingRows;
+    int pendingCols;
+    bool valuesDirty;
+    QRect dirtyArea;                   // changed by updateValues since the last upload
+
+    ColorLut colors;
+    bool colorsDirty;
+
+    int rangeLow;
+    int rangeHigh;
+    QRectF targetRect;
+};
+
+#endif // GLHEATMAPRENDERER_H
@@ -0,0 +1,98 @@
+#ifndef GRIDCOLORIZER_H
+#define GRIDCOLORIZER_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include <cmath>
+#include <type_traits>
+#include "colorkernel.h"
+#include "colorlut.h"
+#include "densegrid.h"
+#include "rowbands.h"
+
+// Colours DenseGrid<T> cells through a ColorLut stretched over [low, high].
+//
+// Each element type gets its own inner loop, chosen at compile time, and
+// no cell is converted to another type first:
+//   int            the runtime-dispatched SIMD ColorKernel
+//   quint16        a 65536-entry table (value → colour) built once per range,
+//                  so a cell is a single load with no arithmetic
+//   float, double  normalised in the element's own precision (a straight
+//                  loop the compiler vectorises); NaN cells get noData
+template <typename T>
+class GridColorizer
+{
+    static_assert(std::is_same<T, int>::value || std::is_same<T, quint16>::value
+                      || std::is_floating_point<T>::value,
+                  "GridColorizer handles int, quint16, float and double cells");
+
+public:
+    GridColorizer(const ColorLut &lut, double low, double high, QRgb noData = qRgb(0, 0, 0))
+        : colors(lut), rangeLow(low), rangeHigh(qMax(high, low + (std::is_integral<T>::value ? 1.0 : 1e-12))),
+          noDataColor(noData)
+    {
+        if constexpr (std::is_same<T, quint16>::value) {
+            direct.resize(65536);
+            const double span = rangeHigh - rangeLow;
+            for (int v = 0; v < 65536; ++v)
+                direct[v] = colors.lookup(qBound(0.0, (v - rangeLow) / span, 1.0));
+        }
+    }
+
+    void colorizeRow(const T *values, int count, QRgb *out) const
+    {
+        const QRgb *lut = colors.table();
+        const int last = colors.size() - 1;
+
+        if constexpr (std::is_same<T, int>::value) {
+            const int low = int(std::floor(rangeLow));
+            ColorKernel::colorizeRow(values, count, low, float(last / (rangeHigh - low)), lut, colors.size(), out);
+        } else if constexpr (std::is_same<T, quint16>::value) {
+            const QRgb *table = direct.constData();
+            for (int j = 0; j < count; ++j)
+                out[j] = table[values[j]];
+        } else {
+            const T low = T(rangeLow);
+            const T scale = T(last / (rangeHigh - rangeLow));
+
+            for (int j = 0; j < count; ++j) {
+                const T x = (values[j] - low) * scale + T(0.5);
+                const int index = x > T(0) ? (x < T(last) ? int(x) : last) : 0;   // NaN → 0
+                out[j] = values[j] == values[j] ? lut[index] : noDataColor;
+            }
+        }
+    }
+
+    // area of grid (the whole grid when null) → image of the same size,
+    // row bands in parallel
+    void colorize(const DenseGrid<T> &grid, QImage &image, QRect area = QRect()) const
+    {
+        if (area.isNull())
+            area = QRect(0, 0, grid.cols(), grid.rows());
+
+        if (image.size() != area.size() || image.format() != QImage::Format_RGB32)
+            image = QImage(area.size(), QImage::Format_RGB32);
+        if (image.isNull() || colors.isEmpty())
+            return;
+
+        uchar *bits = image.bits();
+        const qsizetype bytesPerLine = image.bytesPerLine();
+
+        forEachRowBand(area.height(), [&](int firstRow, int endRow, int) {
+            for (int i = firstRow; i < endRow; ++i) {
+                colorizeRow(grid.row(area.top() + i) + area.left(), area.width(),
+                            reinterpret_cast<QRgb *>(bits + i * bytesPerLine));
+            }
+        });
+    }
+
+private:
+    ColorLut colors;
+    double rangeLow;
+    double rangeHigh;
+    QRgb noDataColor;
+    QVector<QRgb> direct;    // quint16 only
+};
+
+#endif // GRIDCOLORIZER_H
@@ -0,0 +1,233 @@
+#include "gridgenerator.h"
+#include "rowbands.h"
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Salts that keep the pattern parameters independent of the cell noise
+const quint64 PeakSalt = 0x632BE59BD9B4E019ULL;
+const quint64 OctaveSalt = 0x8CB92BA72F3D8DD7ULL;
+
+quint64 splitMix64(quint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Bijective 32-bit finaliser (good avalanche for two multiplies)
+inline quint32 mix32(quint32 x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Two 32-bit keys per row from the 64-bit seed; cells then only need
+// 32-bit lanes
+struct RowKey
+{
+    quint32 a;
+    quint32 b;
+};
+
+RowKey rowKey(quint64 seed, int row)
+{
+    const quint64 k = splitMix64(seed ^ splitMix64(quint64(quint32(row))));
+    return { quint32(k), quint32(k >> 32) };
+}
+
+// Distinct columns give distinct words within a row (both steps are bijective)
+inline quint32 cellWord(const RowKey &key, quint32 col)
+{
+    return mix32(mix32(col ^ key.a) + key.b);
+}
+
+// [0, 1) from the top 24 bits
+inline float unit(quint32 word)
+{
+    return float(word >> 8) * (1.0f / 16777216.0f);
+}
+
+inline float smooth(float t)
+{
+    return t * t * (3.0f - 2.0f * t);
+}
+
+struct Peak
+{
+    float cx;
+    float cy;
+    float inv2Sigma2;    // 1 / (2 sigma^2)
+    float amplitude;
+};
+
+// Adds weight × one octave of value noise (lattice spacing `cell` cells) to row r
+void addNoiseOctave(quint64 seed, int r, int cols, float cell, float weight,
+                    QVector<float> &line, float *shape)
+{
+    const float y = (r + 0.5f) / cell;
+    const int j = int(y);
+    const float ty = smooth(y - j);
+
+    // Lattice values of this row, interpolated between lattice rows j and j + 1
+    const int points = int((cols - 0.5f) / cell) + 2;
+    line.resize(points);
+
+    const RowKey top = rowKey(seed, j);
+    const RowKey bottom = rowKey(seed, j + 1);
+    for (int i = 0; i < points; ++i) {
+        const float v0 = unit(cellWord(top, quint32(i)));
+        const float v1 = unit(cellWord(bottom, quint32(i)));
+        line[i] = v0 + (v1 - v0) * ty;
+    }
+
+    for (int c = 0; c < cols; ++c) {
+        const float x = (c + 0.5f) / cell;
+        const int i = int(x);
+        const float tx = smooth(x - i);
+        shape[c] += weight * (line[i] + (line[i + 1] - line[i]) * tx);
+    }
+}
+
+} // namespace
+
+quint32 GridGenerator::cellBits(quint64 seed, int row, int col)
+{
+    return cellWord(rowKey(seed, row), quint32(col));
+}
+
+bool GridGenerator::patternFromName(const QString &name, Pattern *pattern)
+{
+    const QString key = name.toLower();
+
+    if (key == "uniform")
+        *pattern = Uniform;
+    else if (key == "gradient")
+        *pattern = Gradient;
+    else if (key == "gaussians")
+        *pattern = Gaussians;
+    else if (key == "noise")
+        *pattern = Noise;
+    else
+        return false;
+
+    return true;
+}
+
+void GridGenerator::fill(DenseGrid<int> &grid, quint64 seed, int low, int high, Pattern pattern)
+{
+    if (grid.isEmpty())
+        return;
+
+    if (high < low)
+        std::swap(low, high);
+
+    const int rows = grid.rows();
+    const int cols = grid.cols();
+    const quint64 span = quint64(qint64(high) - low) + 1;       // up to 2^32 values
+
+    if (pattern == Uniform) {
+        // Multiply-shift maps the 32-bit word onto [0, span) without a division
+        forEachRowBand(rows, [&](int firstRow, int endRow, int) {
+            for (int r = firstRow; r < endRow; ++r) {
+                const RowKey key = rowKey(seed, r);
+                int *out = grid.row(r);
+
+                for (int c = 0; c < cols; ++c)
+                    out[c] = int(low + qint64((quint64(cellWord(key, quint32(c))) * span) >> 32));
+            }
+        });
+        return;
+    }
+
+    // Structured patterns: a [0, 1] shape per row, then mapped onto [low, high]
+    const int longest = qMax(rows, cols);
+
+    // Peaks are separable: exp(-(dx² + dy²)/2σ²) = gx(col) · gy(row), so the
+    // column factors are computed once and a row costs one multiply-add per peak
+    QVector<Peak> peaks;
+    QVector<float> columnFactors;
+
+    if (pattern == Gaussians) {
+        const int peakCount = 12;
+        peaks.resize(peakCount);
+        columnFactors.resize(peakCount * cols);
+
+        for (int k = 0; k < peakCount; ++k) {
+            const RowKey key = rowKey(seed ^ PeakSalt, k);
+            const float sigma = (0.03f + 0.12f * unit(cellWord(key, 2))) * longest;
+
+            Peak &peak = peaks[k];
+            peak.cx = unit(cellWord(key, 0)) * cols;
+            peak.cy = unit(cellWord(key, 1)) * rows;
+            peak.inv2Sigma2 = 1.0f / (2.0f * sigma * sigma);
+            peak.amplitude = 0.4f + 0.6f * unit(cellWord(key, 3));
+
+            float *gx = columnFactors.data() + qsizetype(k) * cols;
+            for (int c = 0; c < cols; ++c) {
+                const float dx = c + 0.5f - peak.cx;
+                gx[c] = std::exp(-dx * dx * peak.inv2Sigma2);
+            }
+        }
+    }
+
+    // Noise octaves scale with the grid, so every size shows the same structure
+    const float coarseCell = qMax(4.0f, longest / 6.0f);
+    const float fineCell = qMax(2.0f, coarseCell / 4.0f);
+
+    const float invCols = cols > 1 ? 1.0f / (cols - 1) : 0.0f;
+    const float invRows = rows > 1 ? 1.0f / (rows - 1) : 0.0f;
+    const double top = double(span - 1);
+
+    forEachRowBand(rows, [&](int firstRow, int endRow, int) {
+        QVector<float> shapeRow(cols);
+        QVector<float> lattice;
+        float *shape = shapeRow.data();
+
+        for (int r = firstRow; r < endRow; ++r) {
+            if (pattern == Gradient) {
+                const float fy = r * invRows;
+                for (int c = 0; c < cols; ++c)
+                    shape[c] = 0.5f * (c * invCols + fy);
+            } else if (pattern == Gaussians) {
+                std::fill_n(shape, cols, 0.0f);
+
+                for (int k = 0; k < peaks.size(); ++k) {
+                    const float dy = r + 0.5f - peaks.at(k).cy;
+                    const float gy = peaks.at(k).amplitude * std::exp(-dy * dy * peaks.at(k).inv2Sigma2);
+                    if (gy < 1e-4f)
+                        continue;                                // peak too far from this row
+
+                    const float *gx = columnFactors.constData() + qsizetype(k) * cols;
+                    for (int c = 0; c < cols; ++c)
+                        shape[c] += gy * gx[c];
+                }
+            } else {
+                std::fill_n(shape, cols, 0.0f);
+                addNoiseOctave(seed ^ OctaveSalt, r, cols, coarseCell, 0.7f, lattice, shape);
+                addNoiseOctave(seed ^ (OctaveSalt * 3), r, cols, fineCell, 0.3f, lattice, shape);
+
+                // Value noise clusters around 0.5: stretch it over the range
+                for (int c = 0; c < cols; ++c)
+                    shape[c] = (shape[c] - 0.5f) * 1.8f + 0.5f;
+            }
+
+            // Light per-cell noise on the smooth shapes, then [0, 1] → [low, high]
+            const RowKey key = rowKey(seed, r);
+            const float jitter = pattern == Noise ? 0.0f : 0.04f;
+            int *out = grid.row(r);
+
+            for (int c = 0; c < cols; ++c) {
+                const float f = qBound(0.0f, shape[c] + jitter * (unit(cellWord(key, quint32(c))) - 0.5f), 1.0f);
+                out[c] = int(low + qint64(f * top + 0.5));
+            }
+        }
+    });
+}
@@ -0,0 +1,35 @@
+#ifndef GRIDGENERATOR_H
+#define GRIDGENERATOR_H
+
+#include <QString>
+#include "densegrid.h"
+
+// Reproducible test / benchmark grids.
+//
+// Counter-based: the random word of cell (row, col) is a hash of
+// (seed, row, col) rather than the next state of a sequential generator,
+// so any cell can be produced on its own (no jump-ahead needed), rows are
+// filled in parallel, and the result is the same whatever the thread count.
+// The per-cell hash is plain 32-bit multiply / xor-shift arithmetic the
+// compiler vectorises.
+class GridGenerator
+{
+public:
+    enum Pattern {
+        Uniform,     // independent uniform values
+        Gradient,    // diagonal ramp, light noise
+        Gaussians,   // a dozen gaussian peaks, light noise
+        Noise        // smooth two-octave value noise
+    };
+
+    // Fills every cell with a value in [low, high]
+    static void fill(DenseGrid<int> &grid, quint64 seed, int low, int high, Pattern pattern = Uniform);
+
+    // Uniform 32-bit word of cell (row, col)
+    static quint32 cellBits(quint64 seed, int row, int col);
+
+    // "uniform", "gradient", "gaussians", "noise"
+    static bool patternFromName(const QString &name, Pattern *pattern);
+};
+
+#endif // GRIDGENERATOR_H
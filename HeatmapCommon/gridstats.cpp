@@ -0,0 +1,193 @@
+#include "gridstats.h"
+#include "nodata.h"
+#include "rowbands.h"
+#include <algorithm>
+#include <limits>
+
+GridStats::GridStats()
+{
+    clear();
+}
+
+void GridStats::clear()
+{
+    source = nullptr;
+    bands.clear();
+    bins.clear();
+    hasBins = false;
+    binLo = 0;
+    binSpan = 1;
+    lo = hi = 0;
+    sum = 0;
+    cells = 0;
+}
+
+void GridStats::compute(const DenseGrid<int> &grid)
+{
+    clear();
+    if (grid.isEmpty())
+        return;
+
+    source = &grid;
+    bands.resize((grid.rows() + DefaultBandRows - 1) / DefaultBandRows);
+
+    forEachRowBand(grid.rows(), [this, &grid](int, int, int band) {
+        scanBand(grid, band, false);
+    });
+
+    merge();
+}
+
+void GridStats::update(const DenseGrid<int> &grid, const QRect &area)
+{
+    // Different grid or shape: the band layout no longer fits
+    if (&grid != source || (grid.rows() + DefaultBandRows - 1) / DefaultBandRows != bands.size()) {
+        compute(grid);
+        return;
+    }
+
+    const QRect changed = area & QRect(0, 0, grid.cols(), grid.rows());
+    if (changed.isEmpty())
+        return;
+
+    const int firstBand = changed.top() / DefaultBandRows;
+    const int lastBand = changed.bottom() / DefaultBandRows;
+
+    for (int band = firstBand; band <= lastBand; ++band) {
+        // Take the old band out of the histogram, rescan, put it back
+        if (hasBins) {
+            const QVector<quint32> &old = bands.at(band).bins;
+            for (int b = 0; b < BinCount; ++b)
+                bins[b] -= old.at(b);
+        }
+
+        scanBand(grid, band, hasBins);
+
+        if (hasBins) {
+            const QVector<quint32> &now = bands.at(band).bins;
+            for (int b = 0; b < BinCount; ++b)
+                bins[b] += now.at(b);
+        }
+    }
+
+    merge();
+}
+
+double GridStats::percentile(double p)
+{
+    if (!isValid())
+        return 0.0;
+
+    if (!hasBins)
+        buildHistogram();
+
+    const double target = qBound(0.0, p, 100.0) / 100.0 * double(cells);
+    quint64 below = 0;
+
+    for (int b = 0; b < BinCount; ++b) {
+        if (double(below + bins.at(b)) >= target && bins.at(b) > 0) {
+            // Linear position inside the bin
+            const double t = (target - double(below)) / double(bins.at(b));
+            const double value = binLo + (b + t) * double(binSpan) / BinCount;
+            return qBound(double(lo), value, double(hi));
+        }
+        below += bins.at(b);
+    }
+
+    return hi;
+}
+
+void GridStats::scanBand(const DenseGrid<int> &grid, int band, bool withBins)
+{
+    const int first = band * DefaultBandRows;
+    const int end = qMin(grid.rows(), first + DefaultBandRows);
+    const int cols = grid.cols();
+
+    Band &out = bands[band];
+    int bandLo = std::numeric_limits<int>::max();
+    int bandHi = NoDataValue;
+    qint64 bandSum = 0;
+    qint64 bandCount = 0;
+
+    for (int i = first; i < end; ++i) {
+        const int *row = grid.row(i);
+        int rowLo = std::numeric_limits<int>::max();
+        int rowHi = NoDataValue;
+        qint64 rowSum = 0;
+        int rowCount = 0;
+
+        // Branch-free reductions: vectorised by the compiler. NoDataValue is
+        // the smallest int, so it never raises the maximum; the minimum, sum
+        // and count select it away
+        for (int j = 0; j < cols; ++j) {
+            const bool valid = row[j] != NoDataValue;
+            rowLo = std::min(rowLo, valid ? row[j] : std::numeric_limits<int>::max());
+            rowHi = std::max(rowHi, row[j]);
+            rowSum += valid ? row[j] : 0;
+            rowCount += valid;
+        }
+
+        bandLo = std::min(bandLo, rowLo);
+        bandHi = std::max(bandHi, rowHi);
+        bandSum += rowSum;
+        bandCount += rowCount;
+    }
+
+    out.lo = bandLo;
+    out.hi = bandHi;
+    out.sum = bandSum;
+    out.count = bandCount;
+
+    if (withBins) {
+        out.bins.fill(0, BinCount);
+        for (int i = first; i < end; ++i) {
+            for (int z : grid.rowView(i)) {
+                if (z != NoDataValue)
+                    ++out.bins[binOf(z)];
+            }
+        }
+    }
+}
+
+int GridStats::binOf(int value) const
+{
+    const qint64 offset = qBound<qint64>(0, qint64(value) - binLo, binSpan - 1);
+    return int(offset * BinCount / binSpan);
+}
+
+void GridStats::merge()
+{
+    lo = std::numeric_limits<int>::max();
+    hi = NoDataValue;
+    sum = 0;
+    cells = 0;
+
+    for (const Band &band : bands) {
+        lo = std::min(lo, band.lo);
+        hi = std::max(hi, band.hi);
+        sum += band.sum;
+        cells += band.count;
+    }
+
+    // Nothing but no data
+    if (cells == 0)
+        lo = hi = 0;
+}
+
+void GridStats::buildHistogram()
+{
+    binLo = lo;
+    binSpan = qint64(hi) - lo + 1;
+    hasBins = true;
+
+    const DenseGrid<int> &grid = *source;
+    forEachRowBand(grid.rows(), [this, &grid](int, int, int band) {
+        scanBand(grid, band, true);
+    });
+
+    bins.fill(0, BinCount);
+    for (const Band &band : bands) {
+        for (int b = 0; b < BinCount; ++b)
+            bins[b] += band.bins.at(b);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef GRIDSTATS_H
+#define GRIDSTATS_H
+
+#include <QRect>
+#include <QVector>
+#include "densegrid.h"
+
+// Min / max / mean / percentiles of a DenseGrid<int>, kept per row band.
+//
+// compute() scans every band in parallel (plain min/max/sum loops the
+// compiler vectorises). After that, update() rescans only the bands a
+// changed area touches and re-merges the band summaries, so live data
+// never costs a full rescan. The histogram behind percentile() is built on
+// first use over the [minimum, maximum] of that moment; later values
+// outside it count in the end bins until the next compute(). No-data cells
+// (see nodata.h) are left out of everything, count() included.
+class GridStats
+{
+public:
+    enum { BinCount = 1024 };
+
+    GridStats();
+
+    void compute(const DenseGrid<int> &grid);
+    void update(const DenseGrid<int> &grid, const QRect &area);
+    void clear();
+
+    bool isValid() const { return cells > 0; }
+    int minimum() const { return lo; }
+    int maximum() const { return hi; }
+    double mean() const { return cells ? double(sum) / double(cells) : 0.0; }
+    qint64 count() const { return cells; }
+
+    // Value below which p percent (0–100) of the cells lie, interpolated within a bin
+    double percentile(double p);
+
+private:
+    struct Band
+    {
+        int lo;
+        int hi;
+        qint64 sum;
+        qint64 count;            // cells holding data
+        QVector<quint32> bins;   // empty until the histogram is needed
+    };
+
+    void scanBand(const DenseGrid<int> &grid, int band, bool withBins);
+    int binOf(int value) const;
+    void merge();
+    void buildHistogram();
+
+    const DenseGrid<int> *source;
+    QVector<Band> bands;
+    QVector<quint64> bins;       // sum of the band histograms
+    bool hasBins;
+    int binLo;
+    qint64 binSpan;              // values covered by the histogram (binHi - binLo + 1)
+
+    int lo;
+    int hi;
+    qint64 sum;
+    qint64 cells;
+};
+
+#endif // GRIDSTATS_H
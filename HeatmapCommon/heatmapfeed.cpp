@@ -0,0 +1,97 @@
+#include "heatmapfeed.h"
+#include <cstring>
+
+HeatmapFeed::HeatmapFeed(QObject *parent)
+    : QObject(parent)
+    , notified(false)
+{
+}
+
+void HeatmapFeed::pushFrame(DenseGrid<int> frame)
+{
+    enqueue(Update{ 0, 0, true, std::move(frame) });
+}
+
+void HeatmapFeed::pushRows(int firstRow, DenseGrid<int> block)
+{
+    enqueue(Update{ firstRow, 0, false, std::move(block) });
+}
+
+void HeatmapFeed::pushTile(int row, int col, DenseGrid<int> tile)
+{
+    enqueue(Update{ row, col, false, std::move(tile) });
+}
+
+bool HeatmapFeed::hasPending() const
+{
+    QMutexLocker locker(&mutex);
+    return !pending.isEmpty();
+}
+
+void HeatmapFeed::enqueue(Update update)
+{
+    bool notify = false;
+
+    {
+        QMutexLocker locker(&mutex);
+
+        // A full frame makes every older update irrelevant
+        if (update.fullFrame)
+            pending.clear();
+
+        pending.append(std::move(update));
+
+        notify = !notified;
+        notified = true;
+    }
+
+    // Queued to the feed's thread, so the viewer is woken once per batch
+    if (notify)
+        QMetaObject::invokeMethod(this, "dataAvailable", Qt::QueuedConnection);
+}
+
+QVector<QRect> HeatmapFeed::applyPending(DenseGrid<int> &grid, bool *resized)
+{
+    QVector<Update> batch;
+
+    {
+        QMutexLocker locker(&mutex);
+        batch.swap(pending);
+        notified = false;
+    }
+
+    QVector<QRect> changed;
+
+    if (resized)
+        *resized = false;
+
+    for (Update &update : batch) {
+        if (update.fullFrame) {
+            if (update.data.rows() != grid.rows() || update.data.cols() != grid.cols()) {
+                if (resized)
+                    *resized = true;
+            }
+
+            grid = std::move(update.data);
+            changed.clear();
+            changed.append(QRect(0, 0, grid.cols(), grid.rows()));
+            continue;
+        }
+
+        // Row block / tile, clipped to the grid
+        QRect area = QRect(update.col, update.row, update.data.cols(), update.data.rows())
+                         .intersected(QRect(0, 0, grid.cols(), grid.rows()));
+
+        if (area.isEmpty())
+            continue;
+
+        for (int i = area.top(); i <= area.bottom(); ++i) {
+            const int *src = update.data.row(i - update.row) + (area.left() - update.col);
+            std::memcpy(grid.row(i) + area.left(), src, size_t(area.width()) * sizeof(int));
+        }
+
+        changed.append(area);
+    }
+
+    return changed;
+}
@@ -0,0 +1,57 @@
+#ifndef HEATMAPFEED_H
+#define HEATMAPFEED_H
+
+#include <QObject>
+#include <QMutex>
+#include <QRect>
+#include <QVector>
+#include "densegrid.h"
+
+// Thread-safe inbox for live heatmap data.
+//
+// Producers (any thread) push full frames, row blocks or tiles; the viewer
+// drains the queue on the GUI thread, typically once per display refresh,
+// and gets back the rectangles (in cell coordinates) that actually changed
+// so only those cells are re-coloured and repainted. A full frame supersedes
+// everything queued before it, so a slow consumer never falls behind.
+class HeatmapFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeatmapFeed(QObject *parent = nullptr);
+
+    // --- Producer side (any thread) ---
+    void pushFrame(DenseGrid<int> frame);
+    void pushRows(int firstRow, DenseGrid<int> block);
+    void pushTile(int row, int col, DenseGrid<int> tile);
+
+    bool hasPending() const;
+
+    // --- Consumer side (GUI thread) ---
+    // Applies all queued updates to grid (clipped to its bounds) and returns
+    // the changed areas in cell coordinates. *resized is set when a frame
+    // with different dimensions replaced the grid.
+    QVector<QRect> applyPending(DenseGrid<int> &grid, bool *resized = nullptr);
+
+signals:
+    // Emitted once per batch of pushes (not per push)
+    void dataAvailable();
+
+private:
+    struct Update
+    {
+        int row;
+        int col;
+        bool fullFrame;
+        DenseGrid<int> data;
+    };
+
+    void enqueue(Update update);
+
+    mutable QMutex mutex;
+    QVector<Update> pending;
+    bool notified;
+};
+
+#endif // HEATMAPFEED_H
@@ -0,0 +1,150 @@
+#include "heatmaprenderer.h"
+#include "glheatmaprenderer.h"
+#include "colorkernel.h"
+#include "rowbands.h"
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QPainter>
+
+namespace {
+HeatmapRenderer::Backend preferred = HeatmapRenderer::Auto;
+
+// A real display plus a context that can sample float textures
+bool openGLUsable()
+{
+    const QString platform = QGuiApplication::platformName();
+    if (platform == "offscreen" || platform == "minimal" || platform == "vnc")
+        return false;
+
+    QOpenGLContext context;
+    if (!context.create())
+        return false;
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface))
+        return false;
+
+    const QSurfaceFormat format = context.format();
+    const bool floatTextures = format.majorVersion() >= 3
+                               || context.hasExtension("GL_ARB_texture_float")
+                               || context.hasExtension("GL_OES_texture_float");
+    context.doneCurrent();
+    return floatTextures;
+}
+}
+
+void HeatmapRenderer::setPreferredBackend(Backend backend)
+{
+    preferred = backend;
+}
+
+HeatmapRenderer::Backend HeatmapRenderer::preferredBackend()
+{
+    return preferred;
+}
+
+HeatmapRenderer *HeatmapRenderer::create(QWidget *parent)
+{
+    const bool useOpenGL = preferred == OpenGL || (preferred == Auto && openGLUsable());
+
+    if (useOpenGL)
+        return new GlHeatmapRenderer(parent);
+
+    return new SoftwareHeatmapRenderer(parent);
+}
+
+SoftwareHeatmapRenderer::SoftwareHeatmapRenderer(QWidget *parent)
+    : QWidget(parent), rangeLow(0), rangeHigh(1), imageDirty(true)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);   // every paint covers the target area
+}
+
+void SoftwareHeatmapRenderer::setValues(DenseGrid<int> block)
+{
+    values = std::move(block);
+    imageDirty = true;
+}
+
+void SoftwareHeatmapRenderer::updateValues(const QPoint &at, const DenseGrid<int> &patch)
+{
+    const QRect area = QRect(at, QSize(patch.cols(), patch.rows())) & QRect(0, 0, values.cols(), values.rows());
+    if (area.isEmpty())
+        return;
+
+    for (int i = area.top(); i <= area.bottom(); ++i)
+        std::copy_n(patch.row(i - at.y()) + (area.left() - at.x()), area.width(), values.row(i) + area.left());
+
+    // Rest of the image is still current: re-colour just this area
+    if (!imageDirty && !image.isNull())
+        colorizeArea(area, image.bits());
+}
+
+void SoftwareHeatmapRenderer::setColorLut(const ColorLut &lut)
+{
+    colors = lut;
+    imageDirty = true;
+}
+
+void SoftwareHeatmapRenderer::setRange(int low, int high)
+{
+    if (low == rangeLow && high == rangeHigh)
+        return;
+
+    rangeLow = low;
+    rangeHigh = qMax(low + 1, high);
+    imageDirty = true;
+}
+
+void SoftwareHeatmapRenderer::setTarget(const QRectF &target)
+{
+    targetRect = target;
+}
+
+void SoftwareHeatmapRenderer::colorize()
+{
+    imageDirty = false;
+
+    if (values.isEmpty() || colors.isEmpty()) {
+        image = QImage();
+        return;
+    }
+
+    if (image.width() != values.cols() || image.height() != values.rows())
+        image = QImage(values.cols(), values.rows(), QImage::Format_RGB32);
+
+    uchar *bits = image.bits();               // detaches once, before the bands share it
+
+    forEachRowBand(values.rows(), [&](int firstRow, int endRow, int) {
+        colorizeArea(QRect(0, firstRow, values.cols(), endRow - firstRow), bits);
+    });
+}
+
+void SoftwareHeatmapRenderer::colorizeArea(const QRect &area, uchar *bits)
+{
+    const float scale = float(colors.size() - 1) / (rangeHigh - rangeLow);
+    const qsizetype bytesPerLine = image.bytesPerLine();
+
+    for (int i = area.top(); i <= area.bottom(); ++i) {
+        QRgb *line = reinterpret_cast<QRgb *>(bits + i * bytesPerLine) + area.left();
+        ColorKernel::colorizeRow(values.row(i) + area.left(), area.width(), rangeLow, scale,
+                                 colors.table(), colors.size(), line);
+    }
+}
+
+void SoftwareHeatmapRenderer::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    prepareFrame();
+
+    if (imageDirty)
+        colorize();
+
+    QPainter painter(this);
+    if (image.isNull() || !targetRect.contains(QRectF(rect())))
+        painter.fillRect(rect(), Qt::black);
+    painter.drawImage(targetRect, image);
+}
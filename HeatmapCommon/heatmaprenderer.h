@@ -0,0 +1,100 @@
+#ifndef HEATMAPRENDERER_H
+#define HEATMAPRENDERER_H
+
+#include <QImage>
+#include <QRectF>
+#include <QWidget>
+#include <functional>
+#include "colorlut.h"
+#include "densegrid.h"
+
+// Drawing surface for a block of grid values.
+//
+// The viewer hands over raw values, the palette and the value range
+// separately; the backend decides where the value → colour step happens.
+// The OpenGL backend uploads values once as a float texture and applies the
+// palette in the fragment shader, so a palette or range change is a uniform
+// update and zooming only moves a textured quad. The software backend
+// colours on the CPU, but only when values, palette or range changed, and
+// works on any platform (offscreen, llvmpipe, no GPU).
+//
+// Every backend is a QWidget (returned by widget()) owned by its parent;
+// mouse, wheel and key events it does not use propagate to the parent.
+class HeatmapRenderer
+{
+public:
+    enum Backend { Auto, Software, OpenGL };
+
+    virtual ~HeatmapRenderer() {}
+
+    // Backend used by create(); Auto = OpenGL when a context with float
+    // textures can be made on a real display, software otherwise
+    static void setPreferredBackend(Backend backend);
+    static Backend preferredBackend();
+    static HeatmapRenderer *create(QWidget *parent = nullptr);
+
+    virtual QWidget *widget() = 0;
+    virtual const char *backendName() const = 0;
+
+    // Values to show (row-major block); the renderer takes them over
+    virtual void setValues(DenseGrid<int> block) = 0;
+
+    // Overwrites the cells of the current block starting at (at.x() = column,
+    // at.y() = row) with patch; only that area is re-coloured / uploaded
+    virtual void updateValues(const QPoint &at, const DenseGrid<int> &patch) = 0;
+
+    virtual void setColorLut(const ColorLut &lut) = 0;
+
+    // Values low..high are stretched over the palette
+    virtual void setRange(int low, int high) = 0;
+
+    // Where the block lands, in widget coordinates
+    virtual void setTarget(const QRectF &target) = 0;
+
+    // Called at the start of every paint (lazy view updates go here)
+    void setPrepareHandler(std::function<void()> handler) { prepare = std::move(handler); }
+
+protected:
+    void prepareFrame()
+    {
+        if (prepare)
+            prepare();
+    }
+
+private:
+    std::function<void()> prepare;
+};
+
+// CPU backend: ColorKernel into a QImage, one scaled drawImage per paint
+class SoftwareHeatmapRenderer : public QWidget, public HeatmapRenderer
+{
+public:
+    explicit SoftwareHeatmapRenderer(QWidget *parent = nullptr);
+
+    QWidget *widget() override { return this; }
+    const char *backendName() const override { return "software"; }
+
+    void setValues(DenseGrid<int> block) override;
+    void updateValues(const QPoint &at, const DenseGrid<int> &patch) override;
+    void setColorLut(const ColorLut &lut) override;
+    void setRange(int low, int high) override;
+    void setTarget(const QRectF &target) override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void colorize();
+    void colorizeArea(const QRect &area, uchar *bits);
+
+    DenseGrid<int> values;
+    ColorLut colors;
+    int rangeLow;
+    int rangeHigh;
+    QRectF targetRect;
+
+    QImage image;
+    bool imageDirty;
+};
+
+#endif // HEATMAPRENDERER_H
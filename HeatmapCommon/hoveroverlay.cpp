@@ -0,0 +1,39 @@
+#include "hoveroverlay.h"
+
+HoverOverlay::HoverOverlay(QWidget *parent)
+    : QLabel(parent)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setStyleSheet("QLabel { background: rgba(255, 255, 255, 225); color: black;"
+                  " border: 1px solid #808080; padding: 3px; }");
+    hide();
+}
+
+void HoverOverlay::showAt(const QPoint &pos, const QString &info)
+{
+    // Re-layout only when the text changes; moving is cheap
+    if (info != text()) {
+        setText(info);
+        adjustSize();
+    }
+
+    // Below-right of the cursor; flip to the other side near the edges
+    QPoint at = pos + QPoint(16, 16);
+    const QWidget *area = parentWidget();
+
+    if (area) {
+        if (at.x() + width() > area->width())
+            at.rx() = pos.x() - width() - 8;
+        if (at.y() + height() > area->height())
+            at.ry() = pos.y() - height() - 8;
+
+        at.rx() = qMax(0, at.x());
+        at.ry() = qMax(0, at.y());
+    }
+
+    move(at);
+    if (isHidden()) {
+        show();
+        raise();
+    }
+}
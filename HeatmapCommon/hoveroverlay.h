@@ -0,0 +1,18 @@
+#ifndef HOVEROVERLAY_H
+#define HOVEROVERLAY_H
+
+#include <QLabel>
+
+// Small non-modal info box that follows the cursor over a heatmap.
+// It ignores the mouse (events go to the view underneath) and never blocks
+// the event loop, so streaming and repaints carry on while it is shown.
+class HoverOverlay : public QLabel
+{
+public:
+    explicit HoverOverlay(QWidget *parent);
+
+    // Shows text next to pos (parent coordinates), kept inside the parent
+    void showAt(const QPoint &pos, const QString &text);
+};
+
+#endif // HOVEROVERLAY_H
@@ -0,0 +1,197 @@
+#include "matrixfile.h"
+#include <QSaveFile>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+const char Magic[8] = { 'H', 'M', 'A', 'T', 'R', 'I', 'X', '\0' };
+
+bool fail(QString *error, const QString &message)
+{
+    if (error)
+        *error = message;
+    return false;
+}
+
+// a × b; false if the product does not fit in 64 bits
+bool multiply(quint64 a, quint64 b, quint64 *product)
+{
+    if (a != 0 && b > std::numeric_limits<quint64>::max() / a)
+        return false;
+
+    *product = a * b;
+    return true;
+}
+}
+
+MatrixFile::MatrixFile()
+    : mapped(nullptr)
+{
+    std::memset(&header, 0, sizeof(header));
+}
+
+MatrixFile::~MatrixFile()
+{
+    close();
+}
+
+bool MatrixFile::open(const QString &path, QString *error)
+{
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(error, file.errorString());
+
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        close();
+        return fail(error, "File is too short for a matrix header");
+    }
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        close();
+        return fail(error, "Not a matrix file");
+    }
+
+    // Range-checked before it becomes an ElementType
+    if (header.version != Version || header.elementType < Int32 || header.elementType > UInt16) {
+        const QString reason = QString("Unsupported matrix file (version %1, type %2)")
+                                   .arg(header.version).arg(header.elementType);
+        close();
+        return fail(error, reason);
+    }
+
+    // Every size below comes from the file: no product may wrap around
+    const quint64 maxDim = quint64(std::numeric_limits<int>::max());
+    quint64 frameSize = 0;
+    if (header.rows == 0 || header.cols == 0 || header.rows > maxDim || header.cols > maxDim
+        || header.stride < header.cols || header.stride > maxDim
+        || !multiply(header.rows, header.stride, &frameSize)
+        || !multiply(frameSize, quint64(elementSize(elementType())), &frameSize) || frameSize == 0) {
+        close();
+        return fail(error, "Invalid matrix dimensions");
+    }
+
+    const quint64 fileSize = quint64(file.size());
+    if (header.frameCount > fileSize / frameSize || header.frameCount > maxDim) {
+        close();
+        return fail(error, "Invalid frame count");
+    }
+
+    quint64 payloadSize = 0;
+    if (!multiply(frameSize, qMax<quint64>(1, header.frameCount), &payloadSize)
+        || header.payloadOffset < sizeof(header) || header.payloadOffset > fileSize
+        || payloadSize > fileSize - header.payloadOffset) {
+        close();
+        return fail(error, "Matrix payload is truncated");
+    }
+
+    // The viewers scale values by this range: real numbers, lowest first
+    if (!std::isfinite(header.minValue) || !std::isfinite(header.maxValue) || header.minValue > header.maxValue) {
+        close();
+        return fail(error, "Invalid value range");
+    }
+
+    // Private mapping: pages are shared with the page cache until written
+    mapped = file.map(qint64(header.payloadOffset), qint64(payloadSize), QFileDevice::MapPrivateOption);
+    if (!mapped) {
+        QString reason = file.errorString();
+        close();
+        return fail(error, reason);
+    }
+
+    return true;
+}
+
+double MatrixFile::valueAt(int frame, int row, int col) const
+{
+    switch (elementType()) {
+    case Int32:
+        return grid<qint32>(frame).at(row, col);
+    case Float32:
+        return grid<float>(frame).at(row, col);
+    case Float64:
+        return grid<double>(frame).at(row, col);
+    case UInt16:
+        return grid<quint16>(frame).at(row, col);
+    }
+    return 0.0;
+}
+
+void MatrixFile::close()
+{
+    if (mapped)
+        file.unmap(mapped);
+
+    mapped = nullptr;
+    file.close();
+    std::memset(&header, 0, sizeof(header));
+}
+
+int MatrixFile::elementSize(ElementType type)
+{
+    switch (type) {
+    case Int32:
+    case Float32:
+        return 4;
+    case Float64:
+        return 8;
+    case UInt16:
+        return 2;
+    }
+    return 0;
+}
+
+QString MatrixFile::elementTypeName(ElementType type)
+{
+    switch (type) {
+    case Int32:
+        return "int32";
+    case Float32:
+        return "float32";
+    case Float64:
+        return "float64";
+    case UInt16:
+        return "uint16";
+    }
+    return QString("type %1").arg(int(type));
+}
+
+bool MatrixFile::writePayload(const QString &path, ElementType type, int cellSize, int rows, int cols,
+                              qsizetype stride, const QVector<const void *> &frames, double lo, double hi,
+                              QString *error)
+{
+    if (rows <= 0 || cols <= 0 || frames.isEmpty())
+        return fail(error, "Nothing to write");
+
+    Header out;
+    std::memset(&out, 0, sizeof(out));
+    std::memcpy(out.magic, Magic, sizeof(Magic));
+    out.version = Version;
+    out.elementType = type;
+    out.rows = quint32(rows);
+    out.cols = quint32(cols);
+    out.stride = quint64(stride);
+    out.payloadOffset = PayloadAlignment;
+    out.minValue = lo;
+    out.maxValue = hi;
+    out.frameCount = quint64(frames.size());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return fail(error, file.errorString());
+
+    QByteArray headerBlock(PayloadAlignment, '\0');
+    std::memcpy(headerBlock.data(), &out, sizeof(out));
+    file.write(headerBlock);
+
+    // Same padded layout as in memory: each frame in one write
+    for (const void *data : frames)
+        file.write(static_cast<const char *>(data), qint64(rows) * stride * cellSize);
+
+    if (!file.commit())
+        return fail(error, file.errorString());
+
+    return true;
+}
@@ -0,0 +1,151 @@
+#ifndef MATRIXFILE_H
+#define MATRIXFILE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <cmath>
+#include "densegrid.h"
+
+// Binary matrix file, opened by memory-mapping instead of parsing.
+//
+// Layout (native little-endian):
+//   Header   magic "HMATRIX\0", version, element type, rows, cols,
+//            row stride (elements), payload offset, min, max, frame count
+//   padding  up to PayloadAlignment
+//   payload  rows × stride cells of the element type, row-major; stride
+//            pads each row to 64 bytes, the same layout DenseGrid uses in
+//            memory. A time series stores its frames back to back (min /
+//            max cover all of them); frame count 0 reads as one frame, so
+//            files from before frames existed open unchanged
+//
+// The payload starts on a page boundary, so after map() the grid can be
+// used in place: opening costs one header read, and only the pages a view
+// actually touches are read from disk.
+class MatrixFile
+{
+public:
+    enum { Version = 1, PayloadAlignment = 4096 };
+    enum ElementType { Int32 = 1, Float32 = 2, Float64 = 3, UInt16 = 4 };
+
+    // File element type of a C++ cell type (int, float, double, quint16)
+    template <typename T>
+    static constexpr ElementType elementTypeOf();
+
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 elementType;
+        quint32 rows;
+        quint32 cols;
+        quint64 stride;
+        quint64 payloadOffset;
+        double minValue;
+        double maxValue;
+        quint64 frameCount;
+    };
+
+    MatrixFile();
+    ~MatrixFile();
+
+    // Maps the file copy-on-write: cells may be modified in memory (e.g. by
+    // live updates) without ever touching the file
+    bool open(const QString &path, QString *error = nullptr);
+    void close();
+
+    bool isOpen() const { return mapped != nullptr; }
+    ElementType elementType() const { return ElementType(header.elementType); }
+    int rows() const { return int(header.rows); }
+    int cols() const { return int(header.cols); }
+    int frameCount() const { return isOpen() ? int(qMax<quint64>(1, header.frameCount)) : 0; }
+    double minValue() const { return header.minValue; }
+    double maxValue() const { return header.maxValue; }
+
+    // Non-owning grid over one mapped frame; valid until close().
+    // Empty unless T matches elementType() and frame exists
+    template <typename T = int>
+    DenseGrid<T> grid(int frame = 0) const
+    {
+        if (!mapped || header.elementType != quint32(elementTypeOf<T>()) || frame < 0 || frame >= frameCount())
+            return DenseGrid<T>();
+
+        T *first = reinterpret_cast<T *>(mapped) + qsizetype(frame) * rows() * qsizetype(header.stride);
+        return DenseGrid<T>::wrap(first, rows(), cols(), qsizetype(header.stride));
+    }
+
+    // One cell of one frame, whatever the element type
+    double valueAt(int frame, int row, int col) const;
+
+    // Writes grid (and its min/max, NaN and infinite cells skipped) in this format
+    template <typename T>
+    static bool write(const QString &path, const DenseGrid<T> &grid, QString *error = nullptr)
+    {
+        return writeFrames(path, QVector<DenseGrid<T>>() << grid, error);
+    }
+
+    // Writes a time series; every frame must have the same size
+    template <typename T>
+    static bool writeFrames(const QString &path, const QVector<DenseGrid<T>> &frames, QString *error = nullptr)
+    {
+        if (frames.isEmpty())
+            return writePayload(path, elementTypeOf<T>(), sizeof(T), 0, 0, 0, {}, 0.0, 0.0, error);
+
+        const DenseGrid<T> &first = frames.first();
+        for (const DenseGrid<T> &grid : frames) {
+            if (grid.rows() != first.rows() || grid.cols() != first.cols()) {
+                if (error)
+                    *error = "Frames differ in size";
+                return false;
+            }
+
+            // Wrapped frames may be padded differently: copies share one stride
+            if (grid.stride() != first.stride())
+                return writeFrames(path, QVector<DenseGrid<T>>(frames.begin(), frames.end()), error);
+        }
+
+        double lo = 0.0;
+        double hi = 0.0;
+        bool any = false;
+        QVector<const void *> payloads;
+
+        for (const DenseGrid<T> &grid : frames) {
+            for (int i = 0; i < grid.rows(); ++i) {
+                for (T z : grid.rowView(i)) {
+                    if constexpr (std::is_floating_point<T>::value) {
+                        if (!std::isfinite(z))
+                            continue;
+                    }
+                    lo = any ? qMin(lo, double(z)) : double(z);
+                    hi = any ? qMax(hi, double(z)) : double(z);
+                    any = true;
+                }
+            }
+            payloads << static_cast<const void *>(grid.data());
+        }
+
+        return writePayload(path, elementTypeOf<T>(), sizeof(T), first.rows(), first.cols(), first.stride(),
+                            payloads, lo, hi, error);
+    }
+
+    static int elementSize(ElementType type);
+    static QString elementTypeName(ElementType type);
+
+private:
+    Q_DISABLE_COPY(MatrixFile)
+
+    static bool writePayload(const QString &path, ElementType type, int cellSize, int rows, int cols,
+                             qsizetype stride, const QVector<const void *> &frames, double lo, double hi,
+                             QString *error);
+
+    QFile file;
+    Header header;
+    uchar *mapped;
+};
+
+template <> constexpr MatrixFile::ElementType MatrixFile::elementTypeOf<qint32>() { return Int32; }
+template <> constexpr MatrixFile::ElementType MatrixFile::elementTypeOf<float>() { return Float32; }
+template <> constexpr MatrixFile::ElementType MatrixFile::elementTypeOf<double>() { return Float64; }
+template <> constexpr MatrixFile::ElementType MatrixFile::elementTypeOf<quint16>() { return UInt16; }
+
+#endif // MATRIXFILE_H
@@ -0,0 +1,40 @@
+#ifndef NODATA_H
+#define NODATA_H
+
+#include <QRgb>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+// Cells without a value. Float matrix files mark them NaN; the int grids
+// the viewers work on have no NaN, so they use NoDataValue instead (an
+// int32 file cell holding INT_MIN reads as no data too). Folds (pyramid,
+// downsampler, statistics) skip them, and the renderers paint them
+// NoDataColor, black like GridColorizer's NaN cells.
+const int NoDataValue = std::numeric_limits<int>::min();
+const QRgb NoDataColor = qRgb(0, 0, 0);
+
+template <typename T>
+inline bool isNoData(T value)
+{
+    if constexpr (std::is_floating_point<T>::value)
+        return std::isnan(value);
+    else if constexpr (std::is_same<T, int>::value)
+        return value == NoDataValue;
+    else
+        return false;
+}
+
+// What a fold over nothing but no-data cells yields
+template <typename T>
+inline T noDataOf()
+{
+    if constexpr (std::is_floating_point<T>::value)
+        return std::numeric_limits<T>::quiet_NaN();
+    else if constexpr (std::is_same<T, int>::value)
+        return NoDataValue;
+    else
+        return T(0);
+}
+
+#endif // NODATA_H
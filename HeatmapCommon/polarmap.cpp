@@ -0,0 +1,102 @@
+#include "polarmap.h"
+#include "rowbands.h"
+#include <QtMath>
+#include <cmath>
+
+PolarMap::PolarMap()
+    : nRows(0), nCols(0), rowStride(0)
+{
+}
+
+bool PolarMap::matches(const QSize &size, int rows, int cols, qsizetype stride) const
+{
+    return size == mapSize && rows == nRows && cols == nCols && stride == rowStride;
+}
+
+void PolarMap::build(const QSize &size, int rows, int cols, qsizetype stride)
+{
+    mapSize = size;
+    nRows = rows;
+    nCols = cols;
+    rowStride = stride;
+    indices.resize(qMax(0, size.width() * size.height()));
+
+    const int w = size.width();
+    const int h = size.height();
+    if (w <= 0 || h <= 0 || rows <= 0 || cols <= 0) {
+        indices.fill(-1);
+        return;
+    }
+
+    const double cx = w / 2.0;
+    const double cy = h / 2.0;
+    const double radius = qMin(w, h) / 2.0;
+    const double twoPi = 2.0 * M_PI;
+    qint32 *out = indices.data();
+
+    forEachRowBand(h, [&](int firstRow, int endRow, int) {
+        for (int y = firstRow; y < endRow; ++y) {
+            qint32 *line = out + qsizetype(y) * w;
+            const double dy = y + 0.5 - cy;
+
+            for (int x = 0; x < w; ++x) {
+                const double dx = x + 0.5 - cx;
+                const double r = std::sqrt(dx * dx + dy * dy) / radius;
+
+                if (r >= 1.0) {
+                    line[x] = -1;
+                    continue;
+                }
+
+                // Clockwise from the top (screen y grows downwards)
+                double theta = std::atan2(dx, -dy);
+                if (theta < 0.0)
+                    theta += twoPi;
+
+                const int row = qMin(rows - 1, int(r * rows));
+                const int col = qMin(cols - 1, int(theta / twoPi * cols));
+                line[x] = qint32(row * stride + col);
+            }
+        }
+    });
+}
+
+qint32 PolarMap::indexAt(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= mapSize.width() || y >= mapSize.height())
+        return -1;
+
+    return indices.at(y * mapSize.width() + x);
+}
+
+bool PolarMap::cellAt(const QPoint &pixel, int *row, int *col) const
+{
+    const qint32 index = indexAt(pixel.x(), pixel.y());
+    if (index < 0)
+        return false;
+
+    *row = int(index / rowStride);
+    *col = int(index % rowStride);
+    return true;
+}
+
+void PolarMap::gather(const QRgb *cellColors, QRgb background, QImage &out) const
+{
+    if (out.size() != mapSize || out.format() != QImage::Format_RGB32)
+        out = QImage(mapSize, QImage::Format_RGB32);
+
+    const int w = mapSize.width();
+    const qint32 *in = indices.constData();
+    uchar *bits = out.bits();
+    const qsizetype bytesPerLine = out.bytesPerLine();
+
+    forEachRowBand(mapSize.height(), [&](int firstRow, int endRow, int) {
+        for (int y = firstRow; y < endRow; ++y) {
+            const qint32 *index = in + qsizetype(y) * w;
+            QRgb *line = reinterpret_cast<QRgb *>(bits + y * bytesPerLine);
+
+            for (int x = 0; x < w; ++x)
+                line[x] = index[x] >= 0 ? cellColors[index[x]] : background;
+        }
+    });
+}
@@ -0,0 +1,44 @@
+#ifndef POLARMAP_H
+#define POLARMAP_H
+
+#include <QImage>
+#include <QPoint>
+#include <QRgb>
+#include <QSize>
+#include <QVector>
+
+// Per-pixel lookup table for a polar (azimuth / range) view of a grid.
+//
+// Columns are azimuth, 0–360° clockwise from the top; rows are range, row 0
+// at the centre and the last row at the rim of the largest disc that fits
+// the image. build() does the (x, y) → (r, θ) → cell maths once per image
+// size; after that a frame is one gather pass over the pixels and picking
+// is a single table lookup.
+class PolarMap
+{
+public:
+    PolarMap();
+
+    // stride = elements between grid row starts (DenseGrid::stride())
+    void build(const QSize &size, int rows, int cols, qsizetype stride);
+    bool matches(const QSize &size, int rows, int cols, qsizetype stride) const;
+
+    QSize size() const { return mapSize; }
+
+    // Cell offset (row * stride + col) under pixel (x, y); -1 off the disc
+    qint32 indexAt(int x, int y) const;
+
+    bool cellAt(const QPoint &pixel, int *row, int *col) const;
+
+    // out(x, y) = cellColors[indexAt(x, y)], background off the disc
+    void gather(const QRgb *cellColors, QRgb background, QImage &out) const;
+
+private:
+    QSize mapSize;
+    int nRows;
+    int nCols;
+    qsizetype rowStride;
+    QVector<qint32> indices;   // one per pixel, row-major
+};
+
+#endif // POLARMAP_H
@@ -0,0 +1,28 @@
+#ifndef ROWBANDS_H
+#define ROWBANDS_H
+
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+// Fixed band height: band boundaries (and anything keyed on the band index)
+// depend only on the grid size, never on how many threads run them
+enum { DefaultBandRows = 64 };
+
+// Runs work(firstRow, endRow, bandIndex) over [0, rows) in row bands on the
+// global thread pool and waits for all of them.
+template <typename Work>
+void forEachRowBand(int rows, Work work, int bandRows = DefaultBandRows)
+{
+    const int bandCount = (rows + bandRows - 1) / bandRows;
+
+    QVector<int> bands(bandCount);
+    for (int b = 0; b < bandCount; ++b)
+        bands[b] = b;
+
+    QtConcurrent::blockingMap(bands, [&](const int &band) {
+        const int first = band * bandRows;
+        work(first, qMin(rows, first + bandRows), band);
+    });
+}
+
+#endif // ROWBANDS_H
@@ -0,0 +1,441 @@
+#include "tilepyramid.h"
+#include "nodata.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <limits>
+
+namespace {
+const int TileCostKb = 3 * TilePyramid::TileSize * TilePyramid::TileSize * int(sizeof(int)) / 1024;
+
+// Min / max / sum / count of one tile while cells of the level below are folded in.
+// No-data cells are skipped; a cell with none left is no data in all three aggregates
+class TileBuilder
+{
+public:
+    TileBuilder(int rows, int cols)
+        : tile(new TilePyramid::Tile), sum(rows, cols, 0), count(rows, cols, 0)
+    {
+        tile->minValues.resize(rows, cols, std::numeric_limits<int>::max());
+        tile->maxValues.resize(rows, cols, std::numeric_limits<int>::min());
+    }
+
+    // Level 1: straight from the grid, 2 × TileSize square of level-0 cells
+    void foldGrid(const DenseGrid<int> &grid, int tileRow, int tileCol)
+    {
+        const int firstRow = tileRow * TilePyramid::TileSize * 2;
+        const int firstCol = tileCol * TilePyramid::TileSize * 2;
+        const int endRow = qMin(grid.rows(), firstRow + sum.rows() * 2);
+        const int endCol = qMin(grid.cols(), firstCol + sum.cols() * 2);
+
+        for (int i = firstRow; i < endRow; ++i) {
+            const int *row = grid.row(i);
+            const int r = (i - firstRow) >> 1;
+
+            for (int j = firstCol; j < endCol; ++j) {
+                const int v = row[j];
+                fold(r, (j - firstCol) >> 1, v, v, v);
+            }
+        }
+    }
+
+    // Higher levels: child q (0 = top left, 1 = top right, 2, 3 below)
+    void foldChild(int q, const TilePyramid::Tile &child)
+    {
+        const int rowBase = (q >> 1) * TilePyramid::TileSize;
+        const int colBase = (q & 1) * TilePyramid::TileSize;
+
+        for (int r = 0; r < child.minValues.rows(); ++r) {
+            const int *lo = child.minValues.row(r);
+            const int *hi = child.maxValues.row(r);
+            const int *mean = child.meanValues.row(r);
+            const int pr = (rowBase + r) >> 1;
+
+            for (int c = 0; c < child.minValues.cols(); ++c)
+                fold(pr, (colBase + c) >> 1, lo[c], hi[c], mean[c]);
+        }
+    }
+
+    TilePyramid::Tile *finish()
+    {
+        tile->meanValues.resize(sum.rows(), sum.cols());
+        for (int r = 0; r < sum.rows(); ++r) {
+            for (int c = 0; c < sum.cols(); ++c) {
+                const int n = count.at(r, c);
+                if (n == 0) {
+                    tile->minValues.at(r, c) = NoDataValue;
+                    tile->maxValues.at(r, c) = NoDataValue;
+                    tile->meanValues.at(r, c) = NoDataValue;
+                } else {
+                    tile->meanValues.at(r, c) = int((sum.at(r, c) + n / 2) / n);
+                }
+            }
+        }
+        return tile;
+    }
+
+private:
+    // Folds one cell of the level below into its parent (r, c) in this tile
+    void fold(int r, int c, int minV, int maxV, int meanV)
+    {
+        if (meanV == NoDataValue)
+            return;
+
+        int &lo = tile->minValues.at(r, c);
+        int &hi = tile->maxValues.at(r, c);
+        lo = qMin(lo, minV);
+        hi = qMax(hi, maxV);
+        sum.at(r, c) += meanV;
+        count.at(r, c) += 1;
+    }
+
+    TilePyramid::Tile *tile;
+    DenseGrid<qint64> sum;
+    DenseGrid<int> count;
+};
+}
+
+TilePyramid::TilePyramid()
+    : source(nullptr), working(false), building(false), paused(false)
+{
+    pending.level = 0;
+    pending.aggregate = Max;
+    pending.complete = false;
+    setCacheLimit(512);
+}
+
+TilePyramid::~TilePyramid()
+{
+    {
+        QMutexLocker locker(&mutex);
+        queue.clear();                        // the worker stops after its current tile
+    }
+    worker.waitForFinished();
+}
+
+void TilePyramid::setSource(const DenseGrid<int> *grid)
+{
+    QMutexLocker locker(&mutex);
+    waitForTile(&locker);
+
+    source = grid;
+    queue.clear();
+    pending.level = 0;
+    pending.block = DenseGrid<int>();
+    cache.clear();
+}
+
+void TilePyramid::pauseBuilding()
+{
+    QMutexLocker locker(&mutex);
+    paused = true;
+    waitForTile(&locker);
+}
+
+void TilePyramid::resumeBuilding()
+{
+    QMutexLocker locker(&mutex);
+    paused = false;
+    startWorker();
+}
+
+void TilePyramid::setReadyHandler(std::function<void()> handler)
+{
+    QMutexLocker locker(&mutex);
+    ready = std::move(handler);
+}
+
+int TilePyramid::levelCount() const
+{
+    if (!source || source->isEmpty())
+        return 0;
+
+    // Stop once the whole level fits in a single tile
+    int level = 0;
+    while (levelRows(level) > TileSize || levelCols(level) > TileSize)
+        ++level;
+
+    return level + 1;
+}
+
+int TilePyramid::levelRows(int level) const
+{
+    return source ? int((qint64(source->rows()) + (qint64(1) << level) - 1) >> level) : 0;
+}
+
+int TilePyramid::levelCols(int level) const
+{
+    return source ? int((qint64(source->cols()) + (qint64(1) << level) - 1) >> level) : 0;
+}
+
+quint64 TilePyramid::key(int level, int tileRow, int tileCol)
+{
+    return (quint64(level) << 56) | (quint64(tileRow) << 28) | quint64(tileCol);
+}
+
+const TilePyramid::Tile *TilePyramid::tile(int level, int tileRow, int tileCol)
+{
+    QMutexLocker locker(&mutex);
+    waitForTile(&locker);
+    return buildTile(level, tileRow, tileCol);
+}
+
+const TilePyramid::Tile *TilePyramid::buildTile(int level, int tileRow, int tileCol)
+{
+    if (Tile *cached = cache.object(key(level, tileRow, tileCol)))
+        return cached;
+
+    const int rows = qMin(int(TileSize), levelRows(level) - tileRow * TileSize);
+    const int cols = qMin(int(TileSize), levelCols(level) - tileCol * TileSize);
+
+    if (level < 1 || rows <= 0 || cols <= 0)
+        return nullptr;
+
+    TileBuilder builder(rows, cols);
+
+    if (level == 1) {
+        builder.foldGrid(*source, tileRow, tileCol);
+    } else {
+        // From the four child tiles; each child is only used while it is
+        // folded in, so evicting it afterwards is harmless
+        for (int q = 0; q < 4; ++q) {
+            if (const Tile *child = buildTile(level - 1, tileRow * 2 + (q >> 1), tileCol * 2 + (q & 1)))
+                builder.foldChild(q, *child);
+        }
+    }
+
+    Tile *t = builder.finish();
+    cache.insert(key(level, tileRow, tileCol), t, TileCostKb);
+    return t;
+}
+
+bool TilePyramid::gather(int level, const QRect &cells, Aggregate aggregate, DenseGrid<int> *block)
+{
+    QMutexLocker locker(&mutex);
+
+    if (pending.complete && pending.level == level && pending.cells == cells && pending.aggregate == aggregate) {
+        *block = pending.block;               // collected by the worker (changed tiles may be being redone)
+        return true;
+    }
+
+    const QRect tiles = tilesUnder(level, cells);
+    if (level < 1 || cells.isEmpty() || !allBuilt(level, tiles))
+        return false;
+
+    block->resize(cells.height(), cells.width());
+
+    for (int tr = tiles.top(); tr <= tiles.bottom(); ++tr) {
+        for (int tc = tiles.left(); tc <= tiles.right(); ++tc)
+            copyPart(*cache.object(key(level, tr, tc)), aggregate, tr, tc, cells, block);
+    }
+
+    return true;
+}
+
+void TilePyramid::request(int level, const QRect &cells, Aggregate aggregate)
+{
+    QMutexLocker locker(&mutex);
+
+    if (pending.level == level && pending.cells == cells && pending.aggregate == aggregate)
+        return;                               // already being built (or collected)
+
+    // An older view's tiles are not wanted any more
+    queue.clear();
+    pending.level = 0;
+    pending.block = DenseGrid<int>();
+
+    const QRect tiles = tilesUnder(level, cells);
+    if (level < 1 || tiles.isEmpty())
+        return;
+
+    pending.level = level;
+    pending.cells = cells;
+    pending.aggregate = aggregate;
+    pending.block.resize(cells.height(), cells.width());
+    pending.complete = false;
+
+    for (int tr = tiles.top(); tr <= tiles.bottom(); ++tr) {
+        for (int tc = tiles.left(); tc <= tiles.right(); ++tc)
+            queue.append(TileId{ level, tr, tc });
+    }
+
+    startWorker();
+}
+
+void TilePyramid::copyPart(const Tile &tile, Aggregate aggregate, int tileRow, int tileCol,
+                           const QRect &cells, DenseGrid<int> *block)
+{
+    const DenseGrid<int> &values = tile.values(aggregate);
+
+    // Part of this tile inside cells
+    const QRect part = cells & QRect(tileCol * TileSize, tileRow * TileSize, TileSize, TileSize);
+
+    for (int r = part.top(); r <= part.bottom(); ++r) {
+        std::copy_n(values.row(r - tileRow * TileSize) + (part.left() - tileCol * TileSize),
+                    part.width(), block->row(r - cells.top()) + (part.left() - cells.left()));
+    }
+}
+
+QRect TilePyramid::tilesUnder(int level, const QRect &cells) const
+{
+    const QRect clipped = cells & QRect(0, 0, levelCols(level), levelRows(level));
+    if (clipped.isEmpty())
+        return QRect();
+
+    return QRect(QPoint(clipped.left() / TileSize, clipped.top() / TileSize),
+                 QPoint(clipped.right() / TileSize, clipped.bottom() / TileSize));
+}
+
+bool TilePyramid::allBuilt(int level, const QRect &tiles) const
+{
+    if (tiles.isEmpty())
+        return false;
+
+    for (int tr = tiles.top(); tr <= tiles.bottom(); ++tr) {
+        for (int tc = tiles.left(); tc <= tiles.right(); ++tc) {
+            if (!cache.contains(key(level, tr, tc)))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool TilePyramid::exists(const TileId &id) const
+{
+    return id.level >= 1 && id.row * TileSize < levelRows(id.level) && id.col * TileSize < levelCols(id.level);
+}
+
+bool TilePyramid::findMissing(const TileId &id, TileId *missing) const
+{
+    if (!exists(id) || cache.contains(key(id.level, id.row, id.col)))
+        return false;
+
+    // Children first: a tile is only built once the four below it are
+    if (id.level > 1) {
+        for (int q = 0; q < 4; ++q) {
+            if (findMissing(TileId{ id.level - 1, id.row * 2 + (q >> 1), id.col * 2 + (q & 1) }, missing))
+                return true;
+        }
+    }
+
+    *missing = id;
+    return true;
+}
+
+void TilePyramid::waitForTile(QMutexLocker *locker)
+{
+    while (building)
+        tileDone.wait(locker->mutex());
+}
+
+void TilePyramid::startWorker()
+{
+    if (working || paused || queue.isEmpty())
+        return;
+
+    worker.waitForFinished();                 // the previous run is past its last tile
+    working = true;
+    worker = QtConcurrent::run([this]() { buildQueued(); });
+}
+
+void TilePyramid::buildQueued()
+{
+    QMutexLocker locker(&mutex);
+
+    while (!queue.isEmpty() && !paused) {
+        TileId next;
+        if (!findMissing(queue.first(), &next)) {
+            // Requested tile is cached: collect its cells before anything can evict it
+            const TileId id = queue.takeFirst();
+            copyPart(*cache.object(key(id.level, id.row, id.col)), pending.aggregate, id.row, id.col,
+                     pending.cells, &pending.block);
+
+            if (queue.isEmpty()) {
+                pending.complete = true;
+                if (ready)
+                    ready();                  // everything the view asked for is there (again)
+            }
+            continue;
+        }
+
+        // Everything below next is built; fold it without the lock so the GUI
+        // thread can keep gathering. Cached tiles are only dropped (setSource,
+        // invalidate) or evicted (insert) after waiting for this tile
+        const int rows = qMin(int(TileSize), levelRows(next.level) - next.row * TileSize);
+        const int cols = qMin(int(TileSize), levelCols(next.level) - next.col * TileSize);
+        const Tile *children[4] = {};
+        if (next.level > 1) {
+            for (int q = 0; q < 4; ++q)
+                children[q] = cache.object(key(next.level - 1, next.row * 2 + (q >> 1), next.col * 2 + (q & 1)));
+        }
+
+        building = true;
+        locker.unlock();
+
+        TileBuilder builder(rows, cols);
+        if (next.level == 1) {
+            builder.foldGrid(*source, next.row, next.col);
+        } else {
+            for (int q = 0; q < 4; ++q) {
+                if (children[q])
+                    builder.foldChild(q, *children[q]);
+            }
+        }
+        Tile *t = builder.finish();
+
+        locker.relock();
+        building = false;
+        tileDone.wakeAll();
+
+        cache.insert(key(next.level, next.row, next.col), t, TileCostKb);
+    }
+
+    working = false;
+}
+
+void TilePyramid::invalidate(const QRect &area)
+{
+    QMutexLocker locker(&mutex);
+    waitForTile(&locker);
+
+    const int levels = levelCount();
+
+    for (int level = 1; level < levels; ++level) {
+        const int span = TileSize << level;   // level-0 cells per tile side
+
+        for (int tr = area.top() / span; tr <= area.bottom() / span; ++tr)
+            for (int tc = area.left() / span; tc <= area.right() / span; ++tc)
+                cache.remove(key(level, tr, tc));
+    }
+
+    // Requested tiles over the area are collected again; until then gather
+    // keeps returning the previous block, so a stream of changes faster
+    // than the worker never leaves the view without a picture
+    if (pending.level > 0) {
+        const QRect tiles = tilesUnder(pending.level, pending.cells);
+        const int span = TileSize << pending.level;
+
+        for (int tr = tiles.top(); tr <= tiles.bottom(); ++tr) {
+            for (int tc = tiles.left(); tc <= tiles.right(); ++tc) {
+                if (!QRect(tc * span, tr * span, span, span).intersects(area))
+                    continue;
+
+                bool queued = false;
+                for (const TileId &id : queue)
+                    queued = queued || (id.row == tr && id.col == tc);
+
+                if (!queued)
+                    queue.append(TileId{ pending.level, tr, tc });
+            }
+        }
+
+        startWorker();
+    }
+}
+
+void TilePyramid::setCacheLimit(int megabytes)
+{
+    QMutexLocker locker(&mutex);
+    waitForTile(&locker);
+
+    // Room for at least one tile per level so a tile can be built from its children
+    cache.setMaxCost(qMax(megabytes * 1024, 64 * TileCostKb));
+}
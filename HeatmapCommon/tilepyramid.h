@@ -0,0 +1,129 @@
+#ifndef TILEPYRAMID_H
+#define TILEPYRAMID_H
+
+#include <QCache>
+#include <QFuture>
+#include <QMutex>
+#include <QRect>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+#include "densegrid.h"
+
+// Level-of-detail pyramid over a DenseGrid<int>.
+//
+// Level 0 is the grid itself; every level above halves both dimensions and
+// stores min / max / mean of each 2×2 block below it. Levels are split into
+// TileSize × TileSize tiles that are built lazily, the first time a view
+// needs them, and kept in an LRU cache; a tile is built from the four tiles
+// under it, so zooming out never rescans level 0 twice.
+//
+// Viewers copy finished tiles with gather() and request() the ones that are
+// not: a QtConcurrent worker builds them bottom-up and collects the
+// requested cells as each tile is done (so later evictions cannot lose
+// them), and a first look at a huge grid never stalls the GUI thread.
+class TilePyramid
+{
+public:
+    enum { TileSize = 256 };
+    enum Aggregate { Min, Max, Mean };
+
+    struct Tile
+    {
+        DenseGrid<int> minValues;
+        DenseGrid<int> maxValues;
+        DenseGrid<int> meanValues;
+
+        const DenseGrid<int> &values(Aggregate aggregate) const
+        {
+            return aggregate == Min ? minValues : aggregate == Max ? maxValues : meanValues;
+        }
+    };
+
+    TilePyramid();
+    ~TilePyramid();
+
+    // Drops every cached and requested tile, after waiting for the tile being
+    // built; grid must outlive the pyramid (or the next setSource). Call with
+    // nullptr before replacing or unmapping the grid's memory
+    void setSource(const DenseGrid<int> *grid);
+
+    // The worker reads the source grid's cells: writes to them go between
+    // pauseBuilding (waits for the tile being built) and resumeBuilding
+    void pauseBuilding();
+    void resumeBuilding();
+
+    int levelCount() const;
+    int levelRows(int level) const;
+    int levelCols(int level) const;
+
+    // Aggregated tile for level >= 1, built on the spot. The pointer stays
+    // valid until the next tile() call (building another tile may evict it);
+    // only for callers that do not request() tiles
+    const Tile *tile(int level, int tileRow, int tileCol);
+
+    // Copies level cells (level coordinates) into block, cells.topLeft() at
+    // (0, 0), if every tile they touch is cached or they were requested and
+    // the worker has collected them; false (block untouched) otherwise
+    bool gather(int level, const QRect &cells, Aggregate aggregate, DenseGrid<int> *block);
+
+    // Has the worker build and collect level cells, replacing what an older
+    // view asked for (asking again for the same cells keeps the work going);
+    // the ready handler runs on the worker thread once they are collected
+    void request(int level, const QRect &cells, Aggregate aggregate);
+    void setReadyHandler(std::function<void()> handler);
+
+    // Level-0 cells in area changed: drop every cached tile above them
+    void invalidate(const QRect &area);
+
+    void setCacheLimit(int megabytes);
+
+private:
+    struct TileId
+    {
+        int level;
+        int row;
+        int col;
+    };
+
+    // Cells a view asked for and what the worker has collected of them
+    struct Request
+    {
+        int level;                 // 0 = none
+        QRect cells;
+        Aggregate aggregate;
+        DenseGrid<int> block;
+        bool complete;             // every tile collected at least once
+    };
+
+    static quint64 key(int level, int tileRow, int tileCol);
+
+    // Callers hold mutex
+    const Tile *buildTile(int level, int tileRow, int tileCol);
+    bool exists(const TileId &id) const;
+    bool findMissing(const TileId &id, TileId *missing) const;
+    bool allBuilt(int level, const QRect &tiles) const;
+    QRect tilesUnder(int level, const QRect &cells) const;
+    static void copyPart(const Tile &tile, Aggregate aggregate, int tileRow, int tileCol,
+                         const QRect &cells, DenseGrid<int> *block);
+    void waitForTile(QMutexLocker *locker);
+    void startWorker();
+
+    // Worker: builds queued tiles until none are left (or building is paused)
+    void buildQueued();
+
+    const DenseGrid<int> *source;
+    QCache<quint64, Tile> cache;   // cost in KB
+
+    mutable QMutex mutex;          // cache, queue and worker state
+    QWaitCondition tileDone;       // the worker finished (or gave up) a tile
+    QVector<TileId> queue;         // requested tiles not collected yet
+    Request pending;
+    std::function<void()> ready;
+    QFuture<void> worker;
+    bool working;                  // worker running
+    bool building;                 // worker folding a tile without the lock
+    bool paused;
+};
+
+#endif // TILEPYRAMID_H
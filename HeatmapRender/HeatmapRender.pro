@@ -0,0 +1,29 @@
+QT += core gui
+
+# HeatmapCommon also carries the viewers' widget code (renderers, overlay)
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+CONFIG += c++17 cmdline
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+        batchrenderer.cpp \
+        benchmark.cpp \
+        main.cpp
+
+HEADERS += \
+        batchrenderer.h \
+        benchmark.h
+
+include(../HeatmapCommon/HeatmapCommon.pri)
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
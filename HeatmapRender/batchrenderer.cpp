@@ -0,0 +1,217 @@
+#include "batchrenderer.h"
+#include "csvimporter.h"
+#include "gridcolorizer.h"
+#include "gridstats.h"
+#include "matrixfile.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageWriter>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+BatchRenderer::BatchRenderer(const Options &options)
+    : opts(options)
+{
+}
+
+bool BatchRenderer::isTextMatrix(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "csv" || suffix == "tsv" || suffix == "txt";
+}
+
+QStringList BatchRenderer::collectInputs(const QStringList &paths)
+{
+    QStringList inputs;
+
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            inputs << path;
+            continue;
+        }
+
+        // Text matrices by suffix, binary ones by their magic
+        const QFileInfoList entries = QDir(path).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &entry : entries) {
+            if (isTextMatrix(entry.filePath())) {
+                inputs << entry.filePath();
+                continue;
+            }
+
+            QFile file(entry.filePath());
+            if (file.open(QIODevice::ReadOnly) && file.read(8) == QByteArray("HMATRIX\0", 8))
+                inputs << entry.filePath();
+        }
+    }
+
+    return inputs;
+}
+
+BatchRenderer::Result BatchRenderer::render(const QString &inputPath) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    Result result;
+    result.input = inputPath;
+
+    // Text is parsed into an owned int grid; binary files are mapped in place
+    // and rendered in their own element type
+    if (isTextMatrix(inputPath)) {
+        DenseGrid<int> grid;
+        if (CsvImporter::import(inputPath, grid, &result.error))
+            renderGrid(std::move(grid), nullptr, result);
+    } else {
+        MatrixFile file;
+        if (file.open(inputPath, &result.error)) {
+            const double fileRange[2] = { file.minValue(), file.maxValue() };
+
+            switch (file.elementType()) {
+            case MatrixFile::Int32:
+                renderGrid(file.grid<int>(), fileRange, result);
+                break;
+            case MatrixFile::UInt16:
+                renderGrid(file.grid<quint16>(), fileRange, result);
+                break;
+            case MatrixFile::Float32:
+                renderGrid(file.grid<float>(), fileRange, result);
+                break;
+            case MatrixFile::Float64:
+                renderGrid(file.grid<double>(), fileRange, result);
+                break;
+            }
+        }
+    }
+
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+template <typename T>
+bool BatchRenderer::renderGrid(DenseGrid<T> grid, const double *fileRange, Result &result) const
+{
+    if (grid.isEmpty()) {
+        result.error = "Empty matrix";
+        return false;
+    }
+
+    result.rows = grid.rows();
+    result.cols = grid.cols();
+    result.elementType = MatrixFile::elementTypeName(MatrixFile::elementTypeOf<T>());
+
+    // Range over the full-resolution values, before any reduction
+    double low = 0.0;
+    double high = 1.0;
+    if (opts.scaleMode == AutoScale && fileRange) {
+        low = fileRange[0];
+        high = fileRange[1];
+    } else {
+        valueRange(grid, &low, &high);
+    }
+
+    // One output pixel per cell unless the longest side is capped
+    const int longest = qMax(grid.rows(), grid.cols());
+    if (opts.maxSize > 0 && longest > opts.maxSize) {
+        const double factor = double(opts.maxSize) / longest;
+        grid = Downsampler::reduce(grid, qMax(1, int(std::lround(grid.rows() * factor))),
+                                   qMax(1, int(std::lround(grid.cols() * factor))), opts.aggregate);
+    }
+
+    const GridColorizer<T> colorizer(opts.palette, low, high);
+
+    // Whole image, or tiles named <base>_r<row>_c<col> when it is too large
+    const QString base = QDir(opts.outputDir).filePath(QFileInfo(result.input).completeBaseName());
+    const QString suffix = "." + QString::fromLatin1(opts.format);
+    const int tile = opts.tileSize > 0 ? opts.tileSize : qMax(grid.rows(), grid.cols());
+    const bool tiled = grid.rows() > tile || grid.cols() > tile;
+    QImage image;
+
+    for (int r0 = 0, tr = 0; r0 < grid.rows(); r0 += tile, ++tr) {
+        for (int c0 = 0, tc = 0; c0 < grid.cols(); c0 += tile, ++tc) {
+            const QString path = tiled ? QString("%1_r%2_c%3%4").arg(base, QString::number(tr), QString::number(tc), suffix)
+                                       : base + suffix;
+
+            const QRect area(c0, r0, qMin(tile, grid.cols() - c0), qMin(tile, grid.rows() - r0));
+            colorizer.colorize(grid, image, area);
+
+            if (image.isNull()) {
+                result.error = QString("Cannot allocate a %1 x %2 image (lower --tile)").arg(area.width()).arg(area.height());
+                return false;
+            }
+
+            if (!writeImage(image, path, &result.error))
+                return false;
+
+            result.outputs << path;
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+void BatchRenderer::valueRange(const DenseGrid<T> &grid, double *low, double *high) const
+{
+    if (opts.scaleMode == FixedScale) {
+        *low = opts.fixedLow;
+        *high = opts.fixedHigh;
+        return;
+    }
+
+    if constexpr (std::is_same<T, int>::value) {
+        // One parallel pass; the histogram only when percentiles are asked for
+        GridStats stats;
+        stats.compute(grid);
+
+        if (opts.scaleMode == PercentileScale) {
+            *low = std::floor(stats.percentile(1.0));
+            *high = std::ceil(stats.percentile(99.0));
+        } else {
+            *low = stats.minimum();
+            *high = stats.maximum();
+        }
+    } else {
+        // Only reached for percentiles (typed grids come from binary files,
+        // whose header has the min / max): evenly spaced sample of ~1M cells
+        const qint64 cells = grid.cellCount();
+        const qint64 step = qMax(qint64(1), cells / 1000000);
+
+        QVector<T> sample;
+        sample.reserve(int(cells / step) + 1);
+        for (qint64 k = 0; k < cells; k += step) {
+            const T v = grid.at(int(k / grid.cols()), int(k % grid.cols()));
+            if (!std::is_floating_point<T>::value || !std::isnan(double(v)))
+                sample.append(v);
+        }
+
+        if (sample.isEmpty())
+            return;
+
+        const auto nth = [&sample](double p) {
+            auto at = sample.begin() + qint64(p / 100.0 * (sample.size() - 1));
+            std::nth_element(sample.begin(), at, sample.end());
+            return double(*at);
+        };
+        *low = nth(1.0);
+        *high = nth(99.0);
+    }
+}
+
+bool BatchRenderer::writeImage(const QImage &image, const QString &path, QString *error) const
+{
+    QImageWriter writer(path, opts.format);
+    if (opts.quality >= 0)
+        writer.setQuality(opts.quality);
+
+    if (!writer.write(image)) {
+        *error = "Cannot write " + path + ": " + writer.errorString();
+        return false;
+    }
+
+    return true;
+}
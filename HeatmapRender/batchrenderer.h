@@ -0,0 +1,71 @@
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+#include "colorlut.h"
+#include "densegrid.h"
+#include "downsampler.h"
+
+// Renders matrix files (binary or CSV / TSV / text) to image files without
+// a window: load, pick the value range, optionally reduce to a maximum
+// size, colour and write. Binary files are rendered in their own element
+// type (int32, uint16, float32, float64) through GridColorizer<T>.
+//
+// render() is const and keeps no state between calls, so one renderer can
+// serve many files from different threads at once. Images larger than the
+// tile size on either side are written as a set of tiles, so memory stays
+// bounded by one tile whatever the grid size (a binary matrix is mapped,
+// not read).
+class BatchRenderer
+{
+public:
+    enum ScaleMode { AutoScale, PercentileScale, FixedScale };
+
+    struct Options
+    {
+        QString outputDir = ".";
+        QByteArray format = "png";
+        int quality = -1;                    // QImageWriter quality, -1 = format default
+        ColorLut palette;
+        ScaleMode scaleMode = AutoScale;
+        double fixedLow = 0.0;               // FixedScale range
+        double fixedHigh = 1.0;
+        int maxSize = 0;                     // longest image side, 0 = one pixel per cell
+        Downsampler::Mode aggregate = Downsampler::Max;
+        int tileSize = 16384;                // larger images are split into tiles
+    };
+
+    struct Result
+    {
+        QString input;
+        QStringList outputs;
+        int rows = 0;
+        int cols = 0;
+        QString elementType;
+        qint64 elapsedMs = 0;
+        QString error;                       // empty on success
+    };
+
+    explicit BatchRenderer(const Options &options);
+
+    Result render(const QString &inputPath) const;
+
+    // Files as given plus the matrix files directly inside any directories
+    static QStringList collectInputs(const QStringList &paths);
+    static bool isTextMatrix(const QString &path);
+
+private:
+    // fileRange = header min / max, null for text files
+    template <typename T>
+    bool renderGrid(DenseGrid<T> grid, const double *fileRange, Result &result) const;
+    template <typename T>
+    void valueRange(const DenseGrid<T> &grid, double *low, double *high) const;
+    bool writeImage(const QImage &image, const QString &path, QString *error) const;
+
+    Options opts;
+};
+
+#endif // BATCHRENDERER_H
@@ -0,0 +1,353 @@
+#include "benchmark.h"
+#include "cellpicker.h"
+#include "csvimporter.h"
+#include "downsampler.h"
+#include "gridcolorizer.h"
+#include "gridgenerator.h"
+#include "gridstats.h"
+#include "heatmaprenderer.h"
+#include "polarmap.h"
+#include "tilepyramid.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPixmap>
+#include <QSemaphore>
+#include <QTemporaryFile>
+#include <QVector>
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#ifdef Q_OS_UNIX
+#  include <sys/resource.h>
+#endif
+
+namespace {
+
+// Keeps the optimiser from dropping work whose result is otherwise unused
+volatile qint64 sink = 0;
+
+// Best time (ms) of work() over at least three runs and about minSeconds
+template <typename Work>
+double bestOf(double minSeconds, Work work)
+{
+    QElapsedTimer total;
+    total.start();
+
+    double best = std::numeric_limits<double>::max();
+    int runs = 0;
+
+    do {
+        QElapsedTimer timer;
+        timer.start();
+        work();
+        best = qMin(best, timer.nsecsElapsed() / 1e6);
+        ++runs;
+    } while (runs < 3 || (total.elapsed() < qint64(minSeconds * 1000.0) && runs < 1000));
+
+    return best;
+}
+
+double megabytes(qint64 bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+qint64 peakResidentBytes()
+{
+#ifdef Q_OS_UNIX
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#  ifdef Q_OS_MACOS
+        return qint64(usage.ru_maxrss);            // bytes
+#  else
+        return qint64(usage.ru_maxrss) * 1024;     // kilobytes
+#  endif
+    }
+#endif
+    return -1;
+}
+
+// One result line: stage, grid, window, ms per run, ns per unit (cell / pixel / pick)
+void report(QTextStream &out, const QString &stage, int n, const QSize &window,
+            double ms, double units, const QString &unit)
+{
+    const QString grid = QString("%1x%2").arg(n).arg(n);
+    const QString frame = window.isValid() ? QString("%1x%2").arg(window.width()).arg(window.height())
+                                           : QString("-");
+
+    out << stage.leftJustified(22) << grid.rightJustified(12) << frame.rightJustified(11)
+        << QString::number(ms, 'f', 3).rightJustified(12) << " ms"
+        << QString::number(ms * 1e6 / units, 'f', 3).rightJustified(11) << " ns/" << unit << "\n";
+    out.flush();
+}
+
+// Same columns with the throughput (input MB per second) as the per-unit figure
+void reportThroughput(QTextStream &out, const QString &stage, int n, double ms, qint64 bytes)
+{
+    const QString grid = QString("%1x%2").arg(n).arg(n);
+
+    out << stage.leftJustified(22) << grid.rightJustified(12) << QString("-").rightJustified(11)
+        << QString::number(ms, 'f', 3).rightJustified(12) << " ms"
+        << QString::number(megabytes(bytes) * 1000.0 / ms, 'f', 1).rightJustified(11) << " MB/s\n";
+    out.flush();
+}
+
+// SquareMatrix's whole-grid frame: the pyramid level with at most two cells
+// per pixel, gathered if the pyramid has it and otherwise requested from its
+// worker and gathered once the ready handler fires (what the viewer's ready
+// handler re-render does), then reduced to the window and coloured
+void pyramidFrame(TilePyramid &pyramid, QSemaphore &ready, const DenseGrid<int> &grid,
+                  const QSize &window, const GridColorizer<int> &colorizer, QImage &frame)
+{
+    const double cellsPerPixel = qMax(double(grid.cols()) / window.width(), double(grid.rows()) / window.height());
+    int level = 0;
+    while (level + 1 < pyramid.levelCount() && double(qint64(1) << (level + 1)) <= cellsPerPixel)
+        ++level;
+
+    DenseGrid<int> block;
+
+    if (level == 0) {
+        block = grid;
+    } else {
+        const QRect cells(0, 0, pyramid.levelCols(level), pyramid.levelRows(level));
+        if (!pyramid.gather(level, cells, TilePyramid::Max, &block)) {
+            pyramid.request(level, cells, TilePyramid::Max);
+            while (!pyramid.gather(level, cells, TilePyramid::Max, &block))
+                ready.acquire();            // a stale release only costs one more gather
+        }
+    }
+
+    if (block.rows() > window.height() || block.cols() > window.width())
+        block = Downsampler::reduce(block, window.height(), window.width(), Downsampler::Max);
+
+    colorizer.colorize(block, frame);
+}
+
+void runGrid(const Benchmark::Options &options, int n, QTextStream &out)
+{
+    const double cells = double(n) * n;
+    const GridColorizer<int> colorizer(options.palette, 1, 1000);
+    const double minSeconds = options.minSeconds;
+
+    // Generate (uniform 1–1000, as the viewers' random grids)
+    DenseGrid<int> grid(n, n);
+    double ms = bestOf(minSeconds, [&] { GridGenerator::fill(grid, 1, 1, 1000); });
+    report(out, "generate", n, QSize(), ms, cells, "cell");
+
+    ms = bestOf(minSeconds, [&] {
+        GridStats stats;
+        stats.compute(grid);
+        sink = sink + stats.maximum();
+    });
+    report(out, "stats", n, QSize(), ms, cells, "cell");
+
+    // Every cell coloured once, through a 256-row strip (the kernel cost
+    // without a full-size image)
+    QImage strip;
+    ms = bestOf(minSeconds, [&] {
+        for (int r0 = 0; r0 < n; r0 += 256)
+            colorizer.colorize(grid, strip, QRect(0, r0, n, qMin(256, n - r0)));
+    });
+    report(out, "colour", n, QSize(), ms, cells, "cell");
+
+    // The viewers' original layout for comparison: a QVector<QVector<int>>
+    // filled cell by cell from one mt19937, and every cell normalised and
+    // set with setPixelColor (ramp lookup in place of the old if-chain),
+    // through the same 256-row strip
+    {
+        QVector<QVector<int>> nested;
+        ms = bestOf(minSeconds, [&] {
+            std::mt19937 gen(1);
+            std::uniform_int_distribution<> dis(1, 1000);
+            nested.resize(n);
+            for (int i = 0; i < n; ++i) {
+                nested[i].resize(n);
+                for (int j = 0; j < n; ++j)
+                    nested[i][j] = dis(gen);
+            }
+        });
+        report(out, "generate, nested", n, QSize(), ms, cells, "cell");
+
+        QImage nestedStrip(n, qMin(256, n), QImage::Format_RGB32);
+        ms = bestOf(minSeconds, [&] {
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    const double value = double(nested[i][j] - 1) / (1000 - 1);
+                    nestedStrip.setPixelColor(j, i % nestedStrip.height(), QColor(options.palette.lookup(value)));
+                }
+            }
+        });
+        report(out, "colour, nested", n, QSize(), ms, cells, "cell");
+    }
+
+    // CSV import of the same grid (comma separated, one row per line). Only
+    // up to 5000 x 5000 (about 100 MB of text): larger files would just fill
+    // the temp directory
+    if (n <= 5000) {
+        QTemporaryFile csv;
+        if (csv.open()) {
+            QByteArray line;
+            for (int r = 0; r < n; ++r) {
+                line.clear();
+                const int *values = grid.row(r);
+                for (int c = 0; c < n; ++c) {
+                    if (c > 0)
+                        line += ',';
+                    line += QByteArray::number(values[c]);
+                }
+                line += '\n';
+                csv.write(line);
+            }
+            csv.close();
+
+            DenseGrid<int> imported;
+            ms = bestOf(minSeconds, [&] { CsvImporter::import(csv.fileName(), imported); });
+            reportThroughput(out, "csv import", n, ms, csv.size());
+        }
+    }
+
+    // Polar view input: colours per cell (the Polar_Matrix recolour step)
+    DenseGrid<QRgb> cellColors(n, n);
+    forEachRowBand(n, [&](int firstRow, int endRow, int) {
+        for (int r = firstRow; r < endRow; ++r)
+            colorizer.colorizeRow(grid.row(r), n, cellColors.row(r));
+    });
+
+    for (const QSize &window : options.windowSizes) {
+        const double pixels = double(window.width()) * window.height();
+        QImage frame;
+
+        // Zoomed right out: first frame has the worker build the pyramid
+        // tiles, later ones gather them
+        QSemaphore ready;
+        TilePyramid pyramid;
+        pyramid.setReadyHandler([&ready] { ready.release(); });
+        ms = bestOf(minSeconds, [&] {
+            pyramid.setSource(&grid);
+            pyramidFrame(pyramid, ready, grid, window, colorizer, frame);
+        });
+        report(out, "frame, cold pyramid", n, window, ms, pixels, "pixel");
+
+        ms = bestOf(minSeconds, [&] { pyramidFrame(pyramid, ready, grid, window, colorizer, frame); });
+        report(out, "frame, warm pyramid", n, window, ms, pixels, "pixel");
+
+        // Same frame straight from the grid (every cell read)
+        ms = bestOf(minSeconds, [&] {
+            const DenseGrid<int> reduced = Downsampler::reduce(grid, window.height(), window.width(), Downsampler::Max);
+            colorizer.colorize(reduced, frame);
+        });
+        report(out, "frame, direct reduce", n, window, ms, pixels, "pixel");
+
+        // The reduction alone, grid to window, in each aggregate mode
+        const struct { Downsampler::Mode mode; const char *stage; } modes[] = {
+            { Downsampler::Min, "reduce, min" },
+            { Downsampler::Max, "reduce, max" },
+            { Downsampler::Mean, "reduce, mean" },
+        };
+        for (const auto &m : modes) {
+            ms = bestOf(minSeconds, [&] {
+                const DenseGrid<int> reduced = Downsampler::reduce(grid, window.height(), window.width(), m.mode);
+                sink = sink + reduced.rows();
+            });
+            report(out, m.stage, n, window, ms, pixels, "pixel");
+        }
+
+        // What the viewer folds per frame: a pyramid block with up to two
+        // level cells per pixel each way
+        const int blockRows = qMin(n, 2 * window.height());
+        const int blockCols = qMin(n, 2 * window.width());
+        if (blockRows > window.height() || blockCols > window.width()) {
+            DenseGrid<int> block(blockRows, blockCols);
+            for (int r = 0; r < blockRows; ++r)
+                std::copy_n(grid.row(r), blockCols, block.row(r));
+
+            ms = bestOf(minSeconds, [&] {
+                const DenseGrid<int> reduced = Downsampler::reduce(block, window.height(), window.width(), Downsampler::Max);
+                sink = sink + reduced.rows();
+            });
+            report(out, "reduce, 2x block max", n, window, ms, pixels, "pixel");
+        }
+
+        // The viewer's paint: a frame's values handed to the software
+        // renderer and the widget grabbed offscreen (colouring plus the
+        // scaled drawImage); needs the QApplication main() makes for --benchmark
+        if (qobject_cast<QApplication *>(QCoreApplication::instance())) {
+            SoftwareHeatmapRenderer renderer;
+            renderer.resize(window);
+            renderer.setColorLut(options.palette);
+            renderer.setRange(1, 1000);
+            renderer.setTarget(QRectF(QPointF(0, 0), QSizeF(window)));
+
+            const DenseGrid<int> reduced = Downsampler::reduce(grid, window.height(), window.width(), Downsampler::Max);
+            ms = bestOf(minSeconds, [&] {
+                renderer.setValues(reduced);
+                sink = sink + renderer.grab().width();
+            });
+            report(out, "frame, software paint", n, window, ms, pixels, "pixel");
+        }
+
+        // Picking: 1M positions spread over the window
+        CellPicker picker;
+        picker.setGridSize(n, n);
+        picker.setView(QRectF(0, 0, n, n), QRectF(0, 0, window.width(), window.height()));
+
+        const int pickCount = 1 << 20;
+        QVector<QPointF> points(pickCount);
+        for (int k = 0; k < pickCount; ++k) {
+            points[k] = QPointF(GridGenerator::cellBits(7, 0, k) * (window.width() / 4294967296.0),
+                                GridGenerator::cellBits(7, 1, k) * (window.height() / 4294967296.0));
+        }
+
+        ms = bestOf(minSeconds, [&] {
+            qint64 hits = 0;
+            int row = 0;
+            int col = 0;
+            for (const QPointF &p : points) {
+                if (picker.cellAt(p, &row, &col))
+                    hits += row + col;
+            }
+            sink = sink + hits;
+        });
+        report(out, "pick", n, window, ms, pickCount, "pick");
+
+        // Polar view: cell table per size change, then one gather per frame
+        PolarMap polarMap;
+        ms = bestOf(minSeconds, [&] { polarMap.build(window, n, n, cellColors.stride()); });
+        report(out, "polar map", n, window, ms, pixels, "pixel");
+
+        ms = bestOf(minSeconds, [&] { polarMap.gather(cellColors.data(), qRgb(0, 0, 0), frame); });
+        report(out, "polar frame", n, window, ms, pixels, "pixel");
+    }
+
+    out << "  memory: grid " << QString::number(megabytes(qint64(grid.rows()) * grid.stride() * 4), 'f', 1)
+        << " MB, cell colours " << QString::number(megabytes(qint64(cellColors.rows()) * cellColors.stride() * 4), 'f', 1)
+        << " MB";
+
+    const qint64 peak = peakResidentBytes();
+    if (peak >= 0)
+        out << ", peak RSS " << QString::number(megabytes(peak), 'f', 1) << " MB";
+    out << "\n\n";
+    out.flush();
+}
+
+} // namespace
+
+int Benchmark::run(const Options &options, QTextStream &out)
+{
+    if (options.gridSizes.isEmpty() || options.windowSizes.isEmpty() || options.palette.isEmpty()) {
+        out << "Nothing to benchmark\n";
+        return 2;
+    }
+
+    out << "colour kernel: " << ColorKernel::implementationName() << "\n\n";
+    out << QString("stage").leftJustified(22) << QString("grid").rightJustified(12)
+        << QString("window").rightJustified(11) << QString("best run").rightJustified(15)
+        << QString("per unit").rightJustified(14) << "\n";
+
+    for (int n : options.gridSizes)
+        runGrid(options, n, out);
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QList>
+#include <QSize>
+#include <QTextStream>
+#include "colorlut.h"
+
+// Offscreen timings of the viewers' hot paths on generated square grids:
+// generating, statistics, colouring (generating and colouring also on the
+// original QVector<QVector<int>> layout), CSV import, a zoomed-out frame
+// through the tile pyramid's request / gather path (cold and warm) and
+// straight from the grid, the reduction to the window alone (min, max,
+// mean, and the per-frame fold of a pyramid block), the software
+// renderer's paint (widget grabbed offscreen), cell picking, and the polar
+// view's cell table and per-pixel gather.
+//
+// Every stage is repeated until minSeconds have passed (at least three
+// runs) and the best run is reported, as ms per run and ns per cell or
+// pixel (MB/s for the CSV import), followed by the memory the grid and
+// frames take and the peak RSS.
+namespace Benchmark {
+
+struct Options
+{
+    QList<int> gridSizes;        // n for n × n grids
+    QList<QSize> windowSizes;    // frame sizes in pixels
+    ColorLut palette;
+    double minSeconds = 0.25;
+};
+
+// Returns the process exit code
+int run(const Options &options, QTextStream &out);
+
+}
+
+#endif // BENCHMARK_H
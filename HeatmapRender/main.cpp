@@ -0,0 +1,197 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImageWriter>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QVector>
+#include <algorithm>
+#include "batchrenderer.h"
+#include "benchmark.h"
+
+// The benchmark paints a renderer widget, which needs a QApplication; it
+// runs on the offscreen platform unless QT_QPA_PLATFORM names another one.
+// Plain rendering stays a QCoreApplication (no display needed)
+static QCoreApplication *createApplication(int &argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--benchmark") == 0) {
+            if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+            return new QApplication(argc, argv);
+        }
+    }
+    return new QCoreApplication(argc, argv);
+}
+
+int main(int argc, char *argv[])
+{
+    QScopedPointer<QCoreApplication> app(createApplication(argc, argv));
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders heatmap matrix files (binary int32 / uint16 / float32 / float64, or CSV) to images without a window.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "Matrix files, or directories of them.", "<file|dir>...");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Directory for the images.", "dir", ".");
+    parser.addOption(outputOption);
+    QCommandLineOption formatOption(QStringList() << "f" << "format", "Image format: png, tiff (needs the Qt Image Formats plugin), ...", "format", "png");
+    parser.addOption(formatOption);
+    QCommandLineOption qualityOption("quality", "Writer quality / compression (0-100, format specific).", "n", "-1");
+    parser.addOption(qualityOption);
+    QCommandLineOption paletteOption("palette", "Colour ramp file (\"position r g b\" per line).", "file");
+    parser.addOption(paletteOption);
+    QCommandLineOption scaleOption("scale", "Value range: auto (min-max), percentile (1st-99th) or low:high.", "mode", "auto");
+    parser.addOption(scaleOption);
+    QCommandLineOption maxSizeOption("max-size", "Reduce so the longest side is at most this many pixels (0 = one pixel per cell).", "px", "0");
+    parser.addOption(maxSizeOption);
+    QCommandLineOption aggregateOption("aggregate", "Cell aggregate when reducing: max, min or mean.", "mode", "max");
+    parser.addOption(aggregateOption);
+    QCommandLineOption tileOption("tile", "Split images larger than this on either side into tiles.", "px", "16384");
+    parser.addOption(tileOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Files rendered at once (default: one per core).", "n");
+    parser.addOption(jobsOption);
+    QCommandLineOption benchmarkOption("benchmark", "Time the viewers' generate / colour / frame / paint / pick / polar paths offscreen instead of rendering files.");
+    parser.addOption(benchmarkOption);
+    QCommandLineOption benchGridsOption("bench-grids", "Benchmark grid sizes (n for n x n).", "list", "100,1000,5000,10000");
+    parser.addOption(benchGridsOption);
+    QCommandLineOption benchWindowsOption("bench-windows", "Benchmark frame sizes.", "list", "800x600,1920x1080");
+    parser.addOption(benchWindowsOption);
+    parser.process(*app);
+
+    BatchRenderer::Options options;
+    options.outputDir = parser.value(outputOption);
+    options.format = parser.value(formatOption).toLower().toLatin1();
+    options.quality = parser.value(qualityOption).toInt();
+    options.maxSize = qMax(0, parser.value(maxSizeOption).toInt());
+    options.tileSize = qMax(0, parser.value(tileOption).toInt());
+
+    if (!QImageWriter::supportedImageFormats().contains(options.format)) {
+        err << "Unsupported image format: " << options.format << "\n";
+        return 2;
+    }
+
+    // Colour ramp
+    if (parser.isSet(paletteOption)) {
+        bool ok = false;
+        options.palette = ColorLut::fromFile(parser.value(paletteOption), &ok);
+        if (!ok) {
+            err << "Cannot read palette " << parser.value(paletteOption) << "\n";
+            return 2;
+        }
+    } else {
+        options.palette = ColorLut::defaultRamp();
+    }
+
+    if (parser.isSet(benchmarkOption)) {
+        Benchmark::Options bench;
+        bench.palette = options.palette;
+
+        for (const QString &size : parser.value(benchGridsOption).split(',', Qt::SkipEmptyParts)) {
+            const int n = size.trimmed().toInt();
+            if (n > 0)
+                bench.gridSizes << n;
+        }
+
+        for (const QString &size : parser.value(benchWindowsOption).split(',', Qt::SkipEmptyParts)) {
+            const int w = size.section('x', 0, 0).toInt();
+            const int h = size.section('x', 1, 1).toInt();
+            if (w > 0 && h > 0)
+                bench.windowSizes << QSize(w, h);
+        }
+
+        return Benchmark::run(bench, out);
+    }
+
+    // Value range
+    const QString scale = parser.value(scaleOption);
+    if (scale == "percentile") {
+        options.scaleMode = BatchRenderer::PercentileScale;
+    } else if (scale.contains(':')) {
+        bool lowOk = false, highOk = false;
+        options.scaleMode = BatchRenderer::FixedScale;
+        options.fixedLow = scale.section(':', 0, 0).toDouble(&lowOk);
+        options.fixedHigh = scale.section(':', 1, 1).toDouble(&highOk);
+        if (!lowOk || !highOk || options.fixedHigh <= options.fixedLow) {
+            err << "Bad --scale range: " << scale << "\n";
+            return 2;
+        }
+    } else if (scale != "auto") {
+        err << "Unknown --scale mode: " << scale << "\n";
+        return 2;
+    }
+
+    const QString aggregate = parser.value(aggregateOption);
+    if (aggregate == "min")
+        options.aggregate = Downsampler::Min;
+    else if (aggregate == "mean")
+        options.aggregate = Downsampler::Mean;
+    else if (aggregate != "max") {
+        err << "Unknown --aggregate mode: " << aggregate << "\n";
+        return 2;
+    }
+
+    const QStringList inputs = BatchRenderer::collectInputs(parser.positionalArguments());
+    if (inputs.isEmpty()) {
+        err << "No matrix files given\n";
+        parser.showHelp(2);
+    }
+
+    if (!QDir().mkpath(options.outputDir)) {
+        err << "Cannot create " << options.outputDir << "\n";
+        return 2;
+    }
+
+    // Files in parallel (encoding is single-threaded per image); each file
+    // still colours its rows on the global pool
+    QThreadPool pool;
+    if (parser.isSet(jobsOption))
+        pool.setMaxThreadCount(qMax(1, parser.value(jobsOption).toInt()));
+
+    const BatchRenderer renderer(options);
+    QVector<BatchRenderer::Result> results(inputs.size());
+    QMutex outputLock;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < inputs.size(); ++i) {
+        pool.start([&, i]() {
+            results[i] = renderer.render(inputs.at(i));
+
+            // Progress as files finish
+            const BatchRenderer::Result &result = results.at(i);
+            QMutexLocker locker(&outputLock);
+            if (result.error.isEmpty()) {
+                out << result.input << ": " << result.rows << " x " << result.cols << " " << result.elementType << " -> "
+                    << result.outputs.size() << " image(s), " << result.elapsedMs << " ms\n";
+                out.flush();
+            } else {
+                err << result.input << ": " << result.error << "\n";
+                err.flush();
+            }
+        });
+    }
+    pool.waitForDone();
+
+    // Throughput summary
+    const double seconds = qMax(qint64(1), timer.elapsed()) / 1000.0;
+    int rendered = 0;
+    qint64 cells = 0;
+    for (const BatchRenderer::Result &result : results) {
+        if (result.error.isEmpty()) {
+            ++rendered;
+            cells += qint64(result.rows) * result.cols;
+        }
+    }
+
+    out << rendered << " of " << inputs.size() << " files in " << QString::number(seconds, 'f', 2)
+        << " s: " << QString::number(rendered / seconds, 'f', 1) << " images/s, "
+        << QString::number(cells / seconds / 1e6, 'f', 1) << " Mcells/s\n";
+
+    return rendered == inputs.size() ? 0 : 1;
+}
@@ -1,8 +1,8 @@
 #include "mainwindow.h"
 #include <QPainter>
-#include <QMessageBox>
 #include <QInputDialog>
 #include <random>
+#include "colorkernel.h"
 
 // ✅ Helper: Map normalized value (0–1) to heatmap color
 QColor getColorFromValue(double value)
@@ -33,7 +33,7 @@ QColor getColorFromValue(double value)
 
 // ✅ Constructor
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
+    : QMainWindow(parent), hover(nullptr)
 {
     // User input for rows and cols
     bool ok;
@@ -43,6 +43,10 @@ MainWindow::MainWindow(QWidget *parent)
     cols = QInputDialog::getInt(this, "Columns", "Enter number of columns:", 100, 10, 2000, 1, &ok);
     if (!ok) cols = 100;
 
+    // Hover info on plain mouse moves, no modal dialogs
+    setMouseTracking(true);
+    hover = new HoverOverlay(this);
+
     resize(800, 600); // Initial window size
 
     // Fill Z matrix with random values (1 to 1000)
@@ -50,72 +54,116 @@ MainWindow::MainWindow(QWidget *parent)
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dis(1, 1000);
 
-    zValues.resize(rows);
+    zValues.resize(rows, cols);
     for (int i = 0; i < rows; ++i) {
-        zValues[i].resize(cols);
+        int *row = zValues.row(i);
         for (int j = 0; j < cols; ++j) {
-            zValues[i][j] = dis(gen);
+            row[j] = dis(gen);
         }
     }
+
+    stats.compute(zValues);
+    palette = ColorLut::fromFunction(getColorFromValue);
+    recolorCells();
 }
 
 MainWindow::~MainWindow() {}
 
-// ✅ Draw grid of squares with heatmap colors
+// ✅ Colour every cell once (rows × cols colours, not window pixels)
+void MainWindow::recolorCells()
+{
+    cellColors.resize(rows, cols);
+
+    // Normalize (data min–max → palette index)
+    const int low = stats.minimum();
+    const float scale = float(palette.size() - 1) / qMax(1, stats.maximum() - low);
+
+    for (int i = 0; i < rows; ++i) {
+        ColorKernel::colorizeRow(zValues.row(i), cols, low, scale,
+                                 palette.table(), palette.size(), cellColors.row(i));
+    }
+
+    update();
+}
+
+// ✅ Pixel -> cell table for the window in device pixels; only rebuilt on resize
+void MainWindow::ensurePolarMap()
+{
+    const QSize pixels = size() * devicePixelRatioF();
+
+    if (!polarMap.matches(pixels, rows, cols, cellColors.stride()))
+        polarMap.build(pixels, rows, cols, cellColors.stride());
+}
+
+// ✅ Draw the polar view: one gather pass through the precomputed table, then the rim
 void MainWindow::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
 
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    ensurePolarMap();
 
-    int w = width();
-    int h = height();
+    const QRgb background = QWidget::palette().color(QPalette::Window).rgb();
+    polarMap.gather(cellColors.data(), background, frame);
+    frame.setDevicePixelRatio(devicePixelRatioF());
 
-    double cellW = double(w) / cols;
-    double cellH = double(h) / rows;
+    QPainter painter(this);
+    painter.drawImage(0, 0, frame);
 
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            QRectF rect(j * cellW, i * cellH, cellW, cellH);
+    // Rim and azimuth labels (0° at the top, clockwise)
+    const double radius = qMin(width(), height()) / 2.0;
+    const QPointF centre(width() / 2.0, height() / 2.0);
 
-            // Normalize (1–1000 → 0–1)
-            double value = double(zValues[i][j] - 1) / 999.0;
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(Qt::black, 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawEllipse(centre, radius, radius);
+
+    painter.drawText(QPointF(centre.x() + 4, centre.y() - radius + 14), "0°");
+    painter.drawText(QPointF(centre.x() + radius - 30, centre.y() - 4), "90°");
+    painter.drawText(QPointF(centre.x() + 4, centre.y() + radius - 4), "180°");
+    painter.drawText(QPointF(centre.x() - radius + 4, centre.y() - 4), "270°");
+}
 
-            QColor color = getColorFromValue(value);
+// ✅ Show info of the cell under pos in the hover box (picking = one table lookup)
+void MainWindow::showCellInfo(const QPoint &pos)
+{
+    int i, j;
 
-            painter.setBrush(color);
-            painter.setPen(Qt::NoPen);  // faster, clean look
-            painter.drawRect(rect);
-        }
+    ensurePolarMap();
+
+    if (!polarMap.cellAt((QPointF(pos) * devicePixelRatioF()).toPoint(), &i, &j)) {
+        hover->hide();
+        return;
     }
-}
 
-// ✅ Detect clicked cell and show info
-void MainWindow::mousePressEvent(QMouseEvent *event)
-{
-    int w = width();
-    int h = height();
+    int z = zValues.at(i, j);
 
-    double cellW = double(w) / cols;
-    double cellH = double(h) / rows;
+    // Map to real-world angles (column = azimuth, row = distance from the centre)
+    double xAngle = (360.0 / cols) * j;
+    double yAngle = (60.0 / rows) * i;
 
-    int j = event->pos().x() / cellW; // column index
-    int i = event->pos().y() / cellH; // row index
+    QString msg = QString("Row = %1\nCol = %2\nX = %3°\nY = %4°\nValue(Z) = %5")
+                      .arg(i).arg(j)
+                      .arg(xAngle, 0, 'f', 2)
+                      .arg(yAngle, 0, 'f', 2)
+                      .arg(z);
 
-    if (i >= 0 && i < rows && j >= 0 && j < cols) {
-        int z = zValues[i][j];
+    hover->showAt(pos, msg);
+}
 
-        // Map to real-world angles
-        double xAngle = (360.0 / cols) * j;
-        double yAngle = (60.0 / rows) * i;
+// ✅ Detect clicked / hovered cell and show info (non-modal)
+void MainWindow::mousePressEvent(QMouseEvent *event)
+{
+    showCellInfo(event->pos());
+}
 
-        QString msg = QString("Row = %1\nCol = %2\nX = %3°\nY = %4°\nValue(Z) = %5")
-                          .arg(i).arg(j)
-                          .arg(xAngle, 0, 'f', 2)
-                          .arg(yAngle, 0, 'f', 2)
-                          .arg(z);
+void MainWindow::mouseMoveEvent(QMouseEvent *event)
+{
+    showCellInfo(event->pos());
+}
 
-        QMessageBox::information(this, "Cell Info", msg);
-    }
+void MainWindow::leaveEvent(QEvent *event)
+{
+    Q_UNUSED(event);
+    hover->hide();
 }
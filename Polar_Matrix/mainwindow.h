@@ -3,7 +3,12 @@
 
 #include <QMainWindow>
 #include <QMouseEvent>
-#include <vector>
+#include <QImage>
+#include "densegrid.h"
+#include "colorlut.h"
+#include "gridstats.h"
+#include "polarmap.h"
+#include "hoveroverlay.h"
 
 class MainWindow : public QMainWindow
 {
@@ -16,11 +21,25 @@ public:
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
 
 private:
+    void recolorCells();       // call whenever zValues or the palette change
+    void ensurePolarMap();     // (re)builds the pixel -> cell table for the current window size
+    void showCellInfo(const QPoint &pos);   // hover box for the cell under pos (hidden off-grid)
+
     int rows;
     int cols;
-    std::vector<std::vector<int>> zValues;
+    DenseGrid<int> zValues;
+    GridStats stats;           // colour range comes from the data, not a fixed 1–1000
+
+    ColorLut palette;
+    DenseGrid<QRgb> cellColors; // one colour per cell, same layout (stride) as zValues
+
+    PolarMap polarMap;         // device pixel -> cell, rebuilt only when the window size changes
+    QImage frame;              // polar image gathered from cellColors through polarMap
+    HoverOverlay *hover;       // non-modal cell info next to the cursor
 };
 
 #endif // MAINWINDOW_H
@@ -1,5 +1,7 @@
 #include "mainwindow.h"     // Include MainWindow class (our custom heatmap viewer)
 #include <QApplication>     // Include QApplication (manages the Qt application lifecycle)
+#include <QCommandLineParser> // Parses command-line options (--open, --save, --palette, --seed, --pattern, --renderer, --fps, --play, --demo-stream)
+#include <QThread>          // Background producer for --demo-stream
 
 // ============================
 // Function: main
@@ -11,18 +13,98 @@ int main(int argc, char *argv[])
     // argc, argv allow Qt to handle command-line arguments (like style/theme options)
     QApplication app(argc, argv);
 
+    // Command-line options
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption openOption("open", "Matrix file to show: binary (memory-mapped, opens instantly) or .csv/.tsv/.txt (parsed in parallel).", "file");
+    parser.addOption(openOption);
+    QCommandLineOption saveOption("save", "Write the grid as a binary matrix file.", "file");
+    parser.addOption(saveOption);
+    QCommandLineOption paletteOption("palette", "Colour ramp file (\"position r g b\" per line).", "file");
+    parser.addOption(paletteOption);
+    QCommandLineOption seedOption("seed", "Seed for the random grid (same seed = same grid).", "n");
+    parser.addOption(seedOption);
+    QCommandLineOption patternOption("pattern", "Generated grid: uniform, gradient, gaussians or noise.", "name", "uniform");
+    parser.addOption(patternOption);
+    QCommandLineOption rendererOption("renderer", "Drawing backend: auto, software or opengl.", "backend", "auto");
+    parser.addOption(rendererOption);
+    QCommandLineOption fpsOption("fps", "Time series playback speed at 1x, in frames per second.", "n", "25");
+    parser.addOption(fpsOption);
+    QCommandLineOption playOption("play", "Start playing a multi-frame matrix file right away.");
+    parser.addOption(playOption);
+    QCommandLineOption demoStreamOption("demo-stream", "Feed random row blocks from a background thread.");
+    parser.addOption(demoStreamOption);
+    parser.process(app);
+
+    // Drawing backend (auto = OpenGL on a real display with float textures, software otherwise)
+    const QString backend = parser.value(rendererOption);
+    if (backend == "software")
+        HeatmapRenderer::setPreferredBackend(HeatmapRenderer::Software);
+    else if (backend == "opengl")
+        HeatmapRenderer::setPreferredBackend(HeatmapRenderer::OpenGL);
+
+    // Shape of the generated grid (ignored when a file is opened; unknown names stay uniform)
+    GridGenerator::Pattern pattern = GridGenerator::Uniform;
+    GridGenerator::patternFromName(parser.value(patternOption), &pattern);
+
     // Create our main window (the heatmap viewer)
-    MainWindow w;
+    MainWindow w(parser.value(seedOption).toUInt(), parser.value(openOption), pattern);
 
     // Set the window title (appears on the window bar)
     w.setWindowTitle("Dynamic Heatmap Viewer");
 
+    // Optional custom colour ramp
+    if (parser.isSet(paletteOption))
+        w.loadPalette(parser.value(paletteOption));
+
+    // Optional export of the (generated or loaded) grid
+    if (parser.isSet(saveOption))
+        w.saveMatrix(parser.value(saveOption));
+
+    // Time series playback (Space = play / pause in the window)
+    w.setPlaybackRate(parser.value(fpsOption).toDouble());
+    if (parser.isSet(playOption))
+        w.startPlayback();
+
+    // Optional demo producer: pushes 16-row blocks of new values as fast as
+    // it can; the window coalesces them to one re-colour per display frame
+    QThread *producer = nullptr;
+    if (parser.isSet(demoStreamOption)) {
+        HeatmapFeed *feed = w.dataFeed();
+        int rows = w.gridRows();
+        int cols = w.gridCols();
+
+        producer = QThread::create([feed, rows, cols]() {
+            quint64 blockSeed = 12345;
+            int nextRow = 0;
+
+            while (!QThread::currentThread()->isInterruptionRequested()) {
+                DenseGrid<int> block(qMin(16, rows), cols);
+                GridGenerator::fill(block, blockSeed++, 1, 1000);
+
+                feed->pushRows(nextRow, std::move(block));
+                nextRow = (nextRow + 16) % rows;
+                QThread::msleep(1);
+            }
+        });
+        producer->start();
+    }
+
     // Show the main window on the screen
     w.show();
 
     // Start the Qt event loop
     // This keeps the application running and responding to user events (mouse, paint, etc.)
-    return app.exec();
+    int result = app.exec();
+
+    // Stop the demo producer before the window (and its feed) go away
+    if (producer) {
+        producer->requestInterruption();
+        producer->wait();
+        delete producer;
+    }
+
+    return result;
 }
 
 
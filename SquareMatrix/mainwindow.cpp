@@ -1,66 +1,185 @@
 #include "mainwindow.h"       // Include the MainWindow header (class definition)
-#include <QPainter>           // For drawing images and shapes
 #include <QMessageBox>        // For showing message boxes
 #include <QInputDialog>       // For asking user input dialogs (rows & cols)
-#include <random>             // For random number generation
-
-// ============================
-// Function: getColorFromValue
-// Maps a normalized value (0.0 → 1.0) into a QColor (used for heatmap coloring)
-// ============================
-QColor MainWindow::getColorFromValue(double value)
-{
-    // Clamp the value between 0 and 1 (safety check)
-    value = std::max(0.0, std::min(1.0, value));
-
-    // Different color ranges depending on the normalized value
-    if (value < 0.125) { // Very low values → Light Green to Green
-        double t = value / 0.125;
-        return QColor(144 - t*44, 238 - t*83, 144 - t*44);
-    } else if (value < 0.25) { // Green → Dark Green
-        double t = (value - 0.125) / 0.125;
-        return QColor(100 - t*50, 155 - t*55, 100 - t*50);
-    } else if (value < 0.375) { // Dark Green → Light Yellow
-        double t = (value - 0.25) / 0.125;
-        return QColor(50 + t*205, 100 + t*155, 50);
-    } else if (value < 0.5) { // Light Yellow → Yellow
-        double t = (value - 0.375) / 0.125;
-        return QColor(255, 255 - t*55, 50 + t*205);
-    } else if (value < 0.625) { // Yellow → Orange
-        double t = (value - 0.5) / 0.125;
-        return QColor(255, 255 - t*127, 0);
-    } else if (value < 0.75) { // Orange → Light Red
-        double t = (value - 0.625) / 0.125;
-        return QColor(255, 128 - t*50, 0 + t*128);
-    } else if (value < 0.875) { // Light Red → Red
-        double t = (value - 0.75) / 0.125;
-        return QColor(255, 78 - t*78, 128 - t*128);
-    } else { // Red → Dark Red (highest values)
-        double t = (value - 0.875) / 0.125;
-        return QColor(255 - t*100, 0, 0);
-    }
+#include <random>             // std::random_device when no seed is given
+#include "rowbands.h"         // Runs work over row bands on all cores
+#include <QScreen>            // Display refresh rate (for repaint coalescing)
+#include <QWheelEvent>        // Mouse wheel zoom
+#include <QKeyEvent>          // Keyboard shortcuts (Home, A, S, playback)
+#include <cmath>              // std::floor / std::ceil / std::pow for view maths
+#include <algorithm>          // std::copy_n for gathering visible rows
+#include <limits>             // int range for display values
+#include <QFileInfo>          // File suffix → matrix or CSV loader
+#include "csvimporter.h"      // Parallel CSV / text matrix parser
+#include "downsampler.h"      // Min / max / mean reduction to screen resolution
+#include "nodata.h"           // NoDataValue: NaN cells in the int grid
+#include <type_traits>        // std::is_same for the per-type playback reader
+
+// ============================
+// Function: toDisplayInt
+// Display value → int, clamped first (a double beyond the int range, or
+// infinite, cannot be converted). INT_MIN stays free for NoDataValue
+// ============================
+static int toDisplayInt(double z)
+{
+    return int(std::lround(qBound(double(std::numeric_limits<int>::min() + 1), z,
+                                  double(std::numeric_limits<int>::max()))));
+}
+
+// ============================
+// Function: toDisplayGrid
+// Typed matrix (uint16 / float / double) → the int grid the viewer works on:
+// z = round((value - offset) / step), NaN cells → NoDataValue (painted as
+// no data, skipped by statistics and the pyramid). One parallel pass at load
+// ============================
+template <typename T>
+static DenseGrid<int> toDisplayGrid(const DenseGrid<T> &source, double offset, double step)
+{
+    DenseGrid<int> out(source.rows(), source.cols()); // Owned copy (the file may be closed afterwards)
+
+    forEachRowBand(source.rows(), [&](int firstRow, int endRow, int) {
+        for (int i = firstRow; i < endRow; ++i) {
+            const T *in = source.row(i);          // Source row in its own element type
+            int *row = out.row(i);                // Display row
+            for (int j = 0; j < source.cols(); ++j) {
+                const double z = (double(in[j]) - offset) / step;
+                row[j] = std::isnan(z) ? NoDataValue : toDisplayInt(z);
+            }
+        }
+    });
+
+    return out;
+}
+
+// ============================
+// Function: reductionMode
+// Pyramid aggregate → the same fold for the downsampler
+// ============================
+static Downsampler::Mode reductionMode(TilePyramid::Aggregate aggregate)
+{
+    return aggregate == TilePyramid::Min  ? Downsampler::Min
+         : aggregate == TilePyramid::Mean ? Downsampler::Mean
+                                          : Downsampler::Max;
+}
+
+// ============================
+// Function: playbackBlock
+// Playback: the visible cells of one file frame, folded to screen resolution
+// and only then converted to display values, so a frame costs one read of
+// its visible cells plus a screen-sized conversion (runs on the prefetch thread)
+// ============================
+template <typename T>
+static DenseGrid<int> playbackBlock(DenseGrid<T> frame, const QRect &cells, int pixelRows, int pixelCols,
+                                    Downsampler::Mode mode, double offset, double step)
+{
+    if (frame.isEmpty())
+        return DenseGrid<int>();                  // Frame out of range / file closed
+
+    // Visible cells, still in the mapping (no copy)
+    const DenseGrid<T> visible = DenseGrid<T>::wrap(frame.row(cells.top()) + cells.left(),
+                                                    cells.height(), cells.width(), frame.stride());
+    DenseGrid<T> reduced = Downsampler::reduce(visible, pixelRows, pixelCols, mode); // Clamped: never upsamples
+
+    if constexpr (std::is_same<T, int>::value)
+        return reduced;
+    else
+        return toDisplayGrid(reduced, offset, step);
 }
 
 // ============================
 // Constructor: MainWindow
-// Initializes the main window, asks for rows/columns, generates data & heatmap
+// Initializes the main window, opens the data file or asks for rows/columns
+// and generates data
 // ============================
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), rows(0), cols(0), minVal(1), maxVal(1000) // Initialize variables
+MainWindow::MainWindow(quint32 dataSeed, const QString &dataFile, GridGenerator::Pattern dataPattern, QWidget *parent)
+    : QMainWindow(parent), rows(0), cols(0), minVal(1), maxVal(1000), // Initialize variables
+      valueOffset(0.0), valueStep(1.0),
+      scaleMode(FixedScale), scaleLow(1), scaleHigh(1000), seed(dataSeed), pattern(dataPattern),
+      frame(0), playing(false), awaitingFrame(false), frameRate(25.0), playSpeed(1.0), playDirection(1), playStep(1),
+      playTimer(nullptr), aggregate(TilePyramid::Max), renderer(nullptr), viewDirty(true),
+      hover(nullptr), hoverActive(false), panning(false)
 {
-    bool ok; // Flag to check if user clicked "OK" in input dialogs
+    // Drawing surface: OpenGL texture + shader palette when available, software otherwise.
+    // Before each paint it asks us for the visible values if the view changed
+    renderer = HeatmapRenderer::create(this);
+    renderer->setPrepareHandler([this]() {
+        if (viewDirty)
+            renderView();
+    });
+    setCentralWidget(renderer->widget());
+
+    // Pyramid tiles are built on a worker thread: render again once the
+    // ones the view asked for are in (playback shows file frames instead)
+    pyramid.setReadyHandler([this]() {
+        QMetaObject::invokeMethod(this, [this]() {
+            if (playing)
+                return;
+            viewDirty = true;
+            renderer->widget()->update();
+        }, Qt::QueuedConnection);
+    });
+
+    // A frame waited for (seek, new view) goes up as soon as it is read,
+    // not only on the next playback tick
+    prefetcher.setReadyHandler([this](int) {
+        QMetaObject::invokeMethod(this, [this]() {
+            if (playing && awaitingFrame)
+                showPlaybackFrame(frame);
+        }, Qt::QueuedConnection);
+    });
+
+    // Hover info on plain mouse moves (no button needed), drawn over the renderer
+    setMouseTracking(true);
+    renderer->widget()->setMouseTracking(true);
+    hover = new HoverOverlay(renderer->widget());
+
+    // Bake the default colour ramp into a lookup table (once, not per pixel)
+    palette = ColorLut::defaultRamp();
+    renderer->setColorLut(palette);
+
+    // Playback ticks (started by startPlayback; loading a file stops them)
+    playTimer = new QTimer(this);
+    playTimer->setTimerType(Qt::PreciseTimer);
+    connect(playTimer, &QTimer::timeout, this, &MainWindow::advancePlayback);
+
+    // Data file given and readable → nothing to ask or generate
+    // (.csv / .tsv / .txt are parsed, anything else is mapped as a binary matrix)
+    const QString suffix = QFileInfo(dataFile).suffix().toLower();
+    const bool isText = suffix == "csv" || suffix == "tsv" || suffix == "txt";
+
+    if (dataFile.isEmpty() || !(isText ? importCsv(dataFile) : loadMatrix(dataFile))) {
+        bool ok; // Flag to check if user clicked "OK" in input dialogs
+
+        // Ask user for number of rows (between 10 and 20000, default = 100)
+        rows = QInputDialog::getInt(this, "Rows", "Enter number of rows:", 100, 10, 20000, 1, &ok);
+
+        // Ask user for number of columns (between 10 and 20000, default = 100)
+        cols = QInputDialog::getInt(this, "Columns", "Enter number of columns:", 100, 10, 20000, 1, &ok);
+
+        // No seed given: pick one at random
+        if (seed == 0)
+            seed = std::random_device()();
 
-    // Ask user for number of rows (between 10 and 5000, default = 100)
-    rows = QInputDialog::getInt(this, "Rows", "Enter number of rows:", 100, 10, 5000, 1, &ok);
+        // Generate random data for heatmap
+        generateData();
+        stats.clear();
+        applyScaleMode();
 
-    // Ask user for number of columns (between 10 and 5000, default = 100)
-    cols = QInputDialog::getInt(this, "Columns", "Enter number of columns:", 100, 10, 5000, 1, &ok);
+        // Pyramid levels are built lazily, only when a zoomed-out view needs them
+        pyramid.setSource(&zValues);
+        resetView();
+    }
 
-    // Generate random data for heatmap
-    generateData();
+    // Live updates: the feed wakes us once per batch, frameTimer paces
+    // the actual re-colour + repaint to the display refresh rate
+    feed = new HeatmapFeed(this);
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    lastFrame.start();
 
-    // Convert the data into a heatmap image
-    generateHeatmap();
+    connect(feed, &HeatmapFeed::dataAvailable, this, &MainWindow::scheduleFrame);
+    connect(frameTimer, &QTimer::timeout, this, &MainWindow::applyFeedUpdates);
 
     // Resize window to 800x600 pixels
     resize(800, 600);
@@ -72,94 +191,838 @@ MainWindow::MainWindow(QWidget *parent)
 // ============================
 MainWindow::~MainWindow() {}
 
+// ============================
+// Function: loadPalette
+// Loads a custom colour ramp ("position r g b" per line) and re-colours the heatmap
+// ============================
+bool MainWindow::loadPalette(const QString &path)
+{
+    bool ok = false;
+    ColorLut lut = ColorLut::fromFile(path, &ok);
+
+    if (!ok) {
+        QMessageBox::warning(this, "Palette", "Cannot load colour ramp:\n" + path);
+        return false;
+    }
+
+    palette = lut;                       // Swap in the new table
+    renderer->setColorLut(palette);      // Values stay; only the colours change
+    renderer->widget()->update();        // Repaint the window
+    return true;
+}
+
+// ============================
+// Function: loadMatrix
+// Maps a binary matrix file; an int32 grid is used in place (no parse, no
+// copy), so only the pages the view touches are ever read. uint16 grids are
+// copied exactly, float / double ones quantised onto 2^20 steps of their range
+// ============================
+bool MainWindow::loadMatrix(const QString &path)
+{
+    QString error;
+
+    haltPlayback();                           // The prefetch thread must let go of the old mapping
+    pyramid.setSource(nullptr);               // So must the tile builder
+
+    if (!matrixFile.open(path, &error)) {
+        // The previous mapping is gone too: drop a grid that pointed into it
+        if (!zValues.ownsData()) {
+            zValues = DenseGrid<int>();
+            rows = cols = 0;
+            stats.clear();
+            resetView();
+        }
+
+        pyramid.setSource(&zValues);
+
+        QMessageBox::warning(this, "Matrix file", "Cannot open " + path + ":\n" + error);
+        return false;
+    }
+
+    // Colour range from the header (no scan over the data)
+    const double lo = matrixFile.minValue();
+    const double hi = matrixFile.maxValue();
+
+    if (matrixFile.elementType() == MatrixFile::Float32 || matrixFile.elementType() == MatrixFile::Float64) {
+        valueOffset = lo;                     // z = 0 at the file minimum (of all frames)
+        const double span = hi / (1 << 20) - lo / (1 << 20); // 2^20 steps: far finer than the palette
+        valueStep = span > 0.0 ? span : 1.0;  // (split so hi - lo cannot overflow)
+    } else {
+        valueOffset = 0.0;                    // int32 / uint16: exact
+        valueStep = 1.0;
+    }
+
+    loadFrame(0);                             // First frame of a time series
+
+    if (zValues.ownsData() && matrixFile.frameCount() == 1)
+        matrixFile.close();                   // Copied: the mapping is no longer needed
+
+    rows = zValues.rows();
+    cols = zValues.cols();
+
+    // Header range checked finite by MatrixFile::open, but it may lie beyond int
+    minVal = qMin(toDisplayInt(std::floor((lo - valueOffset) / valueStep)), std::numeric_limits<int>::max() - 1);
+    maxVal = qMax(minVal + 1, toDisplayInt(std::ceil((hi - valueOffset) / valueStep)));
+
+    // Statistics only when a scale mode asks for them (a full scan reads every page)
+    stats.clear();
+    applyScaleMode();
+
+    pyramid.setSource(&zValues);              // Old tiles belong to the old grid
+    resetView();
+    updateTitle();
+    return true;
+}
+
+// ============================
+// Function: saveMatrix
+// Writes the current grid as a binary matrix file (for loadMatrix / --open)
+// ============================
+bool MainWindow::saveMatrix(const QString &path)
+{
+    QString error;
+
+    if (!MatrixFile::write(path, zValues, &error)) {
+        QMessageBox::warning(this, "Matrix file", "Cannot write " + path + ":\n" + error);
+        return false;
+    }
+
+    return true;
+}
+
+// ============================
+// Function: importCsv
+// Parses a text matrix in parallel straight into the grid
+// ============================
+bool MainWindow::importCsv(const QString &path)
+{
+    QString error;
+    DenseGrid<int> imported;
+
+    if (!CsvImporter::import(path, imported, &error)) {
+        QMessageBox::warning(this, "CSV import", "Cannot import " + path + ":\n" + error);
+        return false;
+    }
+
+    haltPlayback();
+    pyramid.setSource(nullptr);               // The tile builder may be reading the old grid
+    matrixFile.close();                       // A mapped grid is replaced by owned data
+    frame = 0;
+    zValues = std::move(imported);
+    valueOffset = 0.0;                        // Values are the parsed integers
+    valueStep = 1.0;
+    rows = zValues.rows();
+    cols = zValues.cols();
+
+    // Colour range from the data itself (one parallel pass, kept for later updates)
+    stats.compute(zValues);
+    minVal = stats.minimum();
+    maxVal = qMax(minVal + 1, stats.maximum());
+    applyScaleMode();
+
+    pyramid.setSource(&zValues);
+    resetView();
+    return true;
+}
+
+// ============================
+// Function: applyScaleMode
+// Picks the value range stretched over the palette. Auto / percentile use
+// the cached statistics, so this never rescans the grid once they exist
+// ============================
+bool MainWindow::applyScaleMode()
+{
+    int low = minVal;
+    int high = maxVal;
+
+    if (scaleMode != FixedScale && !zValues.isEmpty()) {
+        if (!stats.isValid())
+            stats.compute(zValues);           // First use: one parallel pass
+
+        if (scaleMode == AutoScale) {
+            low = stats.minimum();
+            high = stats.maximum();
+        } else {
+            low = int(std::floor(stats.percentile(1.0)));  // Clip the outer 1% on each side
+            high = int(std::ceil(stats.percentile(99.0)));
+        }
+    }
+
+    high = qMax(low + 1, high);               // Avoid a zero-width range
+
+    const bool changed = low != scaleLow || high != scaleHigh;
+    scaleLow = low;
+    scaleHigh = high;
+    renderer->setRange(scaleLow, scaleHigh);  // Recolouring is the renderer's job
+    return changed;
+}
+
 // ============================
 // Function: generateData
 // Creates a random 2D grid of values between minVal and maxVal
+// Every cell is a hash of (seed, row, column), so rows are filled in
+// parallel and the same seed always gives the same grid on any machine
 // ============================
 void MainWindow::generateData()
 {
-    std::random_device rd;                        // Random device (entropy source)
-    std::mt19937 gen(rd());                       // Mersenne Twister random number generator
-    std::uniform_int_distribution<> dis(minVal, maxVal); // Uniform distribution between minVal & maxVal
+    zValues.resize(rows, cols);                   // One allocation for the whole grid
+
+    GridGenerator::fill(zValues, seed, minVal, maxVal, pattern); // Parallel, vectorised fill
+}
+
+// ============================
+// Function: renderView
+// Gathers only the visible cells and hands them to the renderer.
+// Zoomed in → straight from the grid; zoomed out → from the pyramid level
+// where one level cell is about one screen pixel, so the cost follows the
+// window size, not the grid size. Levels not built yet are requested from
+// the pyramid's worker and a coarser ready level is shown meanwhile
+// ============================
+void MainWindow::renderView()
+{
+    viewDirty = false;
+    shownCells = QRect();                     // Set again below if the block is one value per cell
+
+    if (zValues.isEmpty() || width() <= 0 || height() <= 0)
+        return;
+
+    // Playing: frames come from the prefetch ring, which must follow the new view
+    if (playing) {
+        restartPrefetch();
+        return;
+    }
+
+    // Grid cells per screen pixel (denser direction) → pyramid level
+    const double cellsPerPixel = qMax(view.width() / width(), view.height() / height());
+    int level = 0;
+    while (level + 1 < pyramid.levelCount() && double(qint64(1) << (level + 1)) <= cellsPerPixel)
+        ++level;
+
+    // Visible cells of a level (grid cells / level cell = 2^level)
+    auto visibleCells = [this](int lv) {
+        const double unit = double(qint64(1) << lv);
+        const int c0 = qMax(0, int(std::floor(view.left() / unit)));
+        const int r0 = qMax(0, int(std::floor(view.top() / unit)));
+        const int c1 = qMin(pyramid.levelCols(lv), int(std::ceil(view.right() / unit)));
+        const int r1 = qMin(pyramid.levelRows(lv), int(std::ceil(view.bottom() / unit)));
+        return QRect(c0, r0, c1 - c0, r1 - r0);
+    };
+
+    QRect cells = visibleCells(level);
+    if (cells.isEmpty())
+        return;
 
-    zValues.resize(rows);                         // Resize vector to number of rows
-    for (int i = 0; i < rows; ++i) {
-        zValues[i].resize(cols);                  // Resize each row to number of columns
-        for (int j = 0; j < cols; ++j) {
-            zValues[i][j] = dis(gen);             // Assign random value to each cell
+    // Visible values, about one per screen pixel
+    DenseGrid<int> block;
+    int shown = level;
+
+    if (level == 0) {
+        // Straight from the grid
+        block.resize(cells.height(), cells.width());
+        for (int r = cells.top(); r <= cells.bottom(); ++r)
+            std::copy_n(zValues.row(r) + cells.left(), cells.width(), block.row(r - cells.top()));
+    } else {
+        // Tiles are built on the pyramid's worker; until this level's are,
+        // the nearest coarser level that is ready stands in (blockier, but
+        // the GUI thread never waits for a build)
+        while (shown < pyramid.levelCount() && !pyramid.gather(shown, visibleCells(shown), aggregate, &block))
+            ++shown;
+
+        if (shown != level)
+            pyramid.request(level, cells, aggregate);   // Ready handler renders again
+
+        if (shown == pyramid.levelCount())
+            return;                           // Nothing built yet: the last picture stays up
+
+        cells = visibleCells(shown);
+    }
+
+    // Where those cells land in the window
+    const double unit = double(qint64(1) << shown);
+    const double sx = width() / view.width();
+    const double sy = height() / view.height();
+    const QRectF target((cells.left() * unit - view.left()) * sx, (cells.top() * unit - view.top()) * sy,
+                        cells.width() * unit * sx, cells.height() * unit * sy);
+    renderer->setTarget(target);
+
+    // The pyramid still leaves up to two level cells per device pixel; fold
+    // them (same aggregate as the pyramid) rather than let the renderer
+    // nearest-sample them, so peaks survive and per-frame work follows
+    // the screen size
+    const qreal dpr = devicePixelRatioF();
+    const int pixelRows = qMax(1, int(std::ceil(target.height() * dpr)));
+    const int pixelCols = qMax(1, int(std::ceil(target.width() * dpr)));
+
+    if (block.rows() > pixelRows || block.cols() > pixelCols)
+        block = Downsampler::reduce(block, pixelRows, pixelCols, reductionMode(aggregate));
+    else if (level == 0)
+        shownCells = cells;
+
+    renderer->setValues(std::move(block));
+}
+
+// ============================
+// Function: screenToCell
+// Maps a window position to (column, row) in cell coordinates through the view
+// ============================
+QPointF MainWindow::screenToCell(const QPointF &pos) const
+{
+    return picker.screenToCell(pos);
+}
+
+// ============================
+// Function: syncPicker
+// The picker sees the same view → window mapping as the renderer
+// ============================
+void MainWindow::syncPicker()
+{
+    picker.setGridSize(rows, cols);
+    picker.setView(view, QRectF(0, 0, width(), height()));
+}
+
+// ============================
+// Function: updateHover / cellInfo
+// Hover box for the cell under the cursor; called on mouse move, zoom and
+// streamed data, so it always shows the current value without blocking
+// ============================
+void MainWindow::updateHover()
+{
+    int i, j;
+
+    if (hoverActive && picker.cellAt(hoverPos, &i, &j))
+        hover->showAt(hoverPos, cellInfo(i, j));
+    else
+        hover->hide();
+}
+
+QString MainWindow::cellInfo(int i, int j) const
+{
+    int z = zValues.at(i, j); // Value at the cell (grid units)
+
+    // Compute angular representation (optional feature)
+    double xAngle = (360.0 / cols) * j;  // Map column to X angle (0–360°)
+    double yAngle = (60.0 / rows) * i;   // Map row to Y angle (0–60°)
+
+    // Float matrix files: back to the real value
+    QString zText = valueStep == 1.0 && valueOffset == 0.0 ? QString::number(z)
+                                                           : QString::number(valueOffset + z * valueStep, 'g', 6);
+    if (z == NoDataValue)
+        zText = "no data";                   // NaN in the file
+
+    // Playing: zValues still holds the paused frame, the file has the shown one
+    if (playing) {
+        const double v = matrixFile.valueAt(frame, i, j);
+        zText = valueStep == 1.0 && valueOffset == 0.0 ? QString::number(qint64(v)) : QString::number(v, 'g', 6);
+        if (std::isnan(v) || (valueStep == 1.0 && valueOffset == 0.0 && v == NoDataValue))
+            zText = "no data";
+    }
+
+    // Coordinates & value
+    return QString("X = %1°\nY = %2°\nZ = %3")
+        .arg(xAngle, 0, 'f', 2)  // X angle, 2 decimal places
+        .arg(yAngle, 0, 'f', 2)  // Y angle, 2 decimal places
+        .arg(zText);             // Actual Z value
+}
+
+// ============================
+// Function: resetView / clampView
+// Whole grid stretched to the window (the original behaviour); view limits
+// ============================
+void MainWindow::resetView()
+{
+    view = QRectF(0, 0, cols, rows);
+    syncPicker();
+    viewDirty = true;
+    renderer->widget()->update();
+}
+
+void MainWindow::clampView()
+{
+    // No further out than the whole grid, no further in than 4 cells
+    QSizeF size(qBound(4.0, view.width(), double(cols)), qBound(4.0, view.height(), double(rows)));
+    QPointF centre = view.center();
+
+    view.setSize(size);
+    view.moveCenter(centre);
+
+    // Keep the view on the grid
+    view.moveLeft(qBound(0.0, view.left(), cols - view.width()));
+    view.moveTop(qBound(0.0, view.top(), rows - view.height()));
+    syncPicker();
+}
+
+// ============================
+// Function: scheduleFrame
+// Called when new data arrived; waits for the next display refresh so that
+// any number of pushes in between cost a single re-colour + repaint
+// ============================
+void MainWindow::scheduleFrame()
+{
+    if (frameTimer->isActive())
+        return;                               // A frame is already scheduled
+
+    qreal hz = screen() ? screen()->refreshRate() : 60.0;
+    int frameMs = qMax(1, int(1000.0 / qMax<qreal>(hz, 1.0)));
+
+    frameTimer->start(qMax<qint64>(0, frameMs - lastFrame.elapsed()));
+}
+
+// ============================
+// Function: applyFeedUpdates
+// Applies queued data and drops stale pyramid tiles. Zoomed in, only the
+// changed visible cells are copied into the renderer and re-coloured;
+// zoomed out, the (screen-sized) view is gathered again
+// ============================
+void MainWindow::applyFeedUpdates()
+{
+    if (playing)
+        return;                               // Recorded frames on screen: live data waits for the pause
+
+    bool resized = false;
+
+    pyramid.pauseBuilding();                  // The tile builder reads zValues
+    QVector<QRect> changed = feed->applyPending(zValues, &resized);
+    if (resized)
+        pyramid.setSource(&zValues);          // New dimensions: old tiles and requests are void
+    pyramid.resumeBuilding();
+
+    lastFrame.restart();
+
+    if (resized) {
+        // New dimensions: new pyramid, show the whole grid (a loaded file is replaced)
+        matrixFile.close();
+        frame = 0;
+        rows = zValues.rows();
+        cols = zValues.cols();
+        stats.clear();                        // Recomputed by applyScaleMode if needed
+        applyScaleMode();
+        resetView();
+        updateHover();
+        return;
+    }
+
+    bool visibleChange = false;
+
+    for (const QRect &area : changed) {
+        pyramid.invalidate(area);
+        if (stats.isValid())
+            stats.update(zValues, area);      // Only the row bands this area touches
+
+        if (!view.intersects(QRectF(area)))
+            continue;                         // Off screen: nothing to redraw
+        visibleChange = true;
+
+        if (viewDirty || shownCells.isEmpty()) {
+            viewDirty = true;                 // Whole view is gathered before the next paint anyway
+            continue;
         }
+
+        // Renderer holds these cells one to one: hand over just the changed part
+        const QRect part = area & shownCells;
+        if (part.isEmpty())
+            continue;
+
+        DenseGrid<int> patch(part.height(), part.width());
+        for (int r = part.top(); r <= part.bottom(); ++r)
+            std::copy_n(zValues.row(r) + part.left(), part.width(), patch.row(r - part.top()));
+
+        renderer->updateValues(part.topLeft() - shownCells.topLeft(), patch);
     }
+
+    // Range moved (auto / percentile modes): every visible colour changes,
+    // but the values on screen stay the same
+    const bool rangeChanged = applyScaleMode();
+
+    if (visibleChange || rangeChanged)
+        renderer->widget()->update();
+
+    if (hoverActive)
+        updateHover();                        // Hovered value may have changed
+}
+
+// ============================
+// Function: frameCount / wrapFrame / loadFrame
+// Frames of the loaded time series (1 for generated, imported or single-frame
+// data); playback loops, so frame indices wrap around both ends
+// ============================
+int MainWindow::frameCount() const
+{
+    return matrixFile.isOpen() ? matrixFile.frameCount() : 1;
+}
+
+int MainWindow::wrapFrame(int index) const
+{
+    const int n = frameCount();
+    return ((index % n) + n) % n;
+}
+
+void MainWindow::loadFrame(int index)
+{
+    pyramid.setSource(nullptr);               // The tile builder may be reading the old frame
+    frame = index;
+
+    switch (matrixFile.elementType()) {
+    case MatrixFile::Int32:
+        zValues = matrixFile.grid<int>(frame);   // Non-owning view over the mapping
+        break;
+    case MatrixFile::UInt16:
+        zValues = toDisplayGrid(matrixFile.grid<quint16>(frame), 0.0, 1.0); // Exact
+        break;
+    case MatrixFile::Float32:
+        zValues = toDisplayGrid(matrixFile.grid<float>(frame), valueOffset, valueStep);
+        break;
+    case MatrixFile::Float64:
+        zValues = toDisplayGrid(matrixFile.grid<double>(frame), valueOffset, valueStep);
+        break;
+    }
+}
+
+// ============================
+// Function: setPlaybackRate / startPlayback / stopPlayback / haltPlayback
+// Playing shows screen-sized blocks the prefetch thread has already read and
+// reduced, so the GUI thread never waits for the disk. Pausing puts the
+// shown frame into zValues again (zoom, pyramid, statistics work as usual)
+// ============================
+void MainWindow::setPlaybackRate(double fps)
+{
+    if (!(fps > 0.0))
+        return;                               // Unparsable / zero: keep the current rate
+
+    frameRate = qMin(fps, 1000.0);
+    if (playing)
+        updatePlaybackRate();
+    updateTitle();
+}
+
+void MainWindow::startPlayback()
+{
+    if (playing || frameCount() < 2)
+        return;                               // Nothing to play
+
+    playing = true;
+    updatePlaybackRate();                     // Starts the timer
+    restartPrefetch();                        // Producer for this view, current frame shown from it
+}
+
+void MainWindow::stopPlayback()
+{
+    if (!playing)
+        return;
+
+    haltPlayback();
+    seekFrame(frame);                         // Full grid of the frame on screen
+
+    if (feed->hasPending())
+        scheduleFrame();                      // Live data that waited during playback
+}
+
+void MainWindow::haltPlayback()
+{
+    playing = false;
+    if (playTimer)
+        playTimer->stop();
+
+    prefetcher.setProducer(FramePrefetcher::Producer(), 0); // Waits for a frame being read
+    awaitingFrame = false;
+    updateTitle();
+}
+
+// ============================
+// Function: updatePlaybackRate
+// One tick per frame, but never more ticks than display refreshes: faster
+// playback advances several frames per tick (skipped frames are not read)
+// ============================
+void MainWindow::updatePlaybackRate()
+{
+    const double frameMs = 1000.0 / (frameRate * playSpeed);
+    const qreal hz = screen() ? screen()->refreshRate() : 60.0;
+    const double displayMs = 1000.0 / qMax<qreal>(hz, 1.0);
+
+    const int perTick = qMax(1, int(std::ceil(displayMs / frameMs - 1e-9)));
+    playStep = playDirection * perTick;
+
+    playTimer->start(qMax(1, int(std::lround(frameMs * perTick))));
+    // Upcoming frames for the new step (the current one first if it is not up yet)
+    prefetcher.setPlayback(awaitingFrame ? frame : wrapFrame(frame + playStep), playStep);
 }
 
 // ============================
-// Function: generateHeatmap
-// Converts the 2D data grid into a QImage (heatmap colors applied)
+// Function: restartPrefetch
+// The reader for the visible cells of any frame at the current window size:
+// the same cells and target rectangle renderView uses at level 0, reduced
+// to device pixels with the current aggregate. Held frames belong to the
+// old view: the ring refills starting with the current frame, and the old
+// block stays up until that frame arrives (nothing is read on this thread)
 // ============================
-void MainWindow::generateHeatmap()
+void MainWindow::restartPrefetch()
 {
-    // Create an image with same size as the grid
-    heatmap = QImage(cols, rows, QImage::Format_RGB32);
+    // Visible cells and where they land in the window
+    const int c0 = qMax(0, int(std::floor(view.left())));
+    const int r0 = qMax(0, int(std::floor(view.top())));
+    const int c1 = qMin(cols, int(std::ceil(view.right())));
+    const int r1 = qMin(rows, int(std::ceil(view.bottom())));
+
+    if (c1 <= c0 || r1 <= r0)
+        return;
 
-    // Loop over every cell in the matrix
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            // Normalize the value between 0 and 1
-            double value = double(zValues[i][j] - minVal) / (maxVal - minVal);
+    const double sx = width() / view.width();
+    const double sy = height() / view.height();
+    playTarget = QRectF((c0 - view.left()) * sx, (r0 - view.top()) * sy, (c1 - c0) * sx, (r1 - r0) * sy);
 
-            // Convert normalized value to a QColor
-            QColor color = getColorFromValue(value);
+    const qreal dpr = devicePixelRatioF();
+    const int pixelRows = qMax(1, int(std::ceil(playTarget.height() * dpr)));
+    const int pixelCols = qMax(1, int(std::ceil(playTarget.width() * dpr)));
 
-            // Set the pixel color in the image
-            heatmap.setPixelColor(j, i, color);
+    // Everything by value: the producer runs on the prefetch thread
+    const MatrixFile *file = &matrixFile;
+    const QRect cells(c0, r0, c1 - c0, r1 - r0);
+    const Downsampler::Mode mode = reductionMode(aggregate);
+    const double offset = valueOffset;
+    const double step = valueStep;
+
+    auto producer = [file, cells, pixelRows, pixelCols, mode, offset, step](int index) {
+        switch (file->elementType()) {
+        case MatrixFile::Int32:
+            return playbackBlock(file->grid<int>(index), cells, pixelRows, pixelCols, mode, 0.0, 1.0);
+        case MatrixFile::UInt16:
+            return playbackBlock(file->grid<quint16>(index), cells, pixelRows, pixelCols, mode, 0.0, 1.0);
+        case MatrixFile::Float32:
+            return playbackBlock(file->grid<float>(index), cells, pixelRows, pixelCols, mode, offset, step);
+        case MatrixFile::Float64:
+            return playbackBlock(file->grid<double>(index), cells, pixelRows, pixelCols, mode, offset, step);
         }
+        return DenseGrid<int>();
+    };
+
+    prefetcher.setProducer(producer, frameCount());
+    prefetcher.setPlayback(frame, playStep);  // Current frame first
+    awaitingFrame = true;
+}
+
+// ============================
+// Function: seekFrame
+// Paused: the frame becomes the grid. Playing: shown from the ring when it
+// is already there; otherwise prefetching restarts at it and the current
+// block stays up until it is read
+// ============================
+void MainWindow::seekFrame(int index)
+{
+    index = wrapFrame(index);
+
+    if (playing) {
+        if (showPlaybackFrame(index))
+            return;
+
+        frame = index;
+        awaitingFrame = true;
+        prefetcher.setPlayback(frame, playStep); // Read it next
+        updateTitle();
+        return;
     }
+
+    loadFrame(index);
+    stats.clear();                            // Statistics belong to the old frame
+    applyScaleMode();
+    pyramid.setSource(&zValues);              // So do the tiles
+    viewDirty = true;
+
+    renderer->widget()->update();
+    updateTitle();
+    if (hoverActive)
+        updateHover();                        // Hovered value of the new frame
 }
 
 // ============================
-// Function: paintEvent
-// Called automatically whenever the window needs to be redrawn
-// Draws the heatmap image scaled to the window size
+// Function: advancePlayback
+// Timer tick: next frame if the prefetch thread has it (or the frame still
+// waited for after a seek or view change). If the disk is slower than the
+// frame rate the current frame simply stays up a little longer; the GUI
+// thread never blocks on a read
 // ============================
-void MainWindow::paintEvent(QPaintEvent *event)
+void MainWindow::advancePlayback()
 {
-    Q_UNUSED(event);             // Prevent unused variable warning
-    QPainter painter(this);      // Create painter to draw on the window
-    painter.drawImage(rect(), heatmap); // Draw the heatmap stretched to fit window
+    if (!playing)
+        return;
+
+    showPlaybackFrame(awaitingFrame ? frame : wrapFrame(frame + playStep)); // Not read yet: next tick
+}
+
+bool MainWindow::showPlaybackFrame(int index)
+{
+    DenseGrid<int> block;
+    if (!prefetcher.takeAndAdvance(index, wrapFrame(index + playStep), playStep, &block))
+        return false;
+
+    frame = index;
+    awaitingFrame = false;
+
+    renderer->setTarget(playTarget);
+    renderer->setValues(std::move(block));    // Colouring stays with the renderer (shader / SIMD)
+    renderer->widget()->update();
+
+    updateTitle();
+    if (hoverActive)
+        updateHover();
+    return true;
 }
 
 // ============================
-// Function: mousePressEvent
-// Called when user clicks inside the window
-// Detects which cell was clicked and shows its value
+// Function: updateTitle
+// "… - frame 12 / 300, playing 2x" for time series (nothing otherwise)
 // ============================
-void MainWindow::mousePressEvent(QMouseEvent *event)
+void MainWindow::updateTitle()
 {
-    int w = width();             // Current window width
-    int h = height();            // Current window height
+    if (frameCount() < 2)
+        return;
 
-    // Calculate width & height of each cell (scaled to window size)
-    double cellW = double(w) / cols;
-    double cellH = double(h) / rows;
+    const QString base = windowTitle().section(" - frame ", 0, 0); // Title without the old frame info
+    const QString state = !playing ? QString("paused")
+                        : playDirection > 0 ? QString("playing %1x").arg(playSpeed)
+                                            : QString("reverse %1x").arg(playSpeed);
+    const QString info = QString("frame %1 / %2, %3").arg(frame + 1).arg(frameCount()).arg(state);
 
-    // Find column (j) and row (i) clicked based on mouse position
-    int j = event->pos().x() / cellW;
-    int i = event->pos().y() / cellH;
+    setWindowTitle(base.isEmpty() ? info : base + " - " + info);
+}
 
-    // Make sure the clicked point is inside grid bounds
-    if (i >= 0 && i < rows && j >= 0 && j < cols) {
-        int z = zValues[i][j];   // Get the actual value at clicked cell
+// ============================
+// Function: resizeEvent
+// Window size changed → different level / pixel mapping
+// ============================
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+    syncPicker();
+    viewDirty = true;
+}
 
-        // Compute angular representation (optional feature)
-        double xAngle = (360.0 / cols) * j;  // Map column to X angle (0–360°)
-        double yAngle = (60.0 / rows) * i;   // Map row to Y angle (0–60°)
+// ============================
+// Function: wheelEvent
+// Zooms in/out keeping the cell under the cursor fixed
+// ============================
+void MainWindow::wheelEvent(QWheelEvent *event)
+{
+    QPointF pos = event->position();
+    QPointF anchor = screenToCell(pos);                          // cell under the cursor
+
+    double factor = std::pow(1.0015, -event->angleDelta().y()); // wheel up = zoom in
+
+    view.setWidth(view.width() * factor);
+    view.setHeight(view.height() * factor);
+    clampView();
+
+    // Put the anchor cell back under the cursor
+    view.moveLeft(anchor.x() - pos.x() * view.width() / width());
+    view.moveTop(anchor.y() - pos.y() * view.height() / height());
+    clampView();
+
+    viewDirty = true;
+    renderer->widget()->update();
+    updateHover();                                               // another cell may be under the cursor now
+}
+
+// ============================
+// Function: keyPressEvent
+// Home = show whole grid, A = cycle max / mean / min aggregation when zoomed out,
+// S = cycle fixed / auto / percentile colour scaling
+// Time series only: Space = play / pause, Left / Right = one frame back / on,
+// PageUp / PageDown = a tenth of the series, [ / ] = half / double speed,
+// R = reverse direction
+// ============================
+void MainWindow::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Home) {
+        resetView();
+    } else if (event->key() == Qt::Key_A) {
+        aggregate = aggregate == TilePyramid::Max  ? TilePyramid::Mean
+                  : aggregate == TilePyramid::Mean ? TilePyramid::Min
+                                                   : TilePyramid::Max;
+        viewDirty = true;
+        renderer->widget()->update();
+    } else if (event->key() == Qt::Key_S) {
+        scaleMode = scaleMode == FixedScale ? AutoScale
+                  : scaleMode == AutoScale  ? PercentileScale
+                                            : FixedScale;
+        applyScaleMode();                // New range only: no values to gather
+        renderer->widget()->update();
+    } else if (frameCount() > 1 && event->key() == Qt::Key_Space) {
+        if (playing)
+            stopPlayback();
+        else
+            startPlayback();
+    } else if (frameCount() > 1 && (event->key() == Qt::Key_Left || event->key() == Qt::Key_Right)) {
+        seekFrame(frame + (event->key() == Qt::Key_Right ? 1 : -1));
+    } else if (frameCount() > 1 && (event->key() == Qt::Key_PageUp || event->key() == Qt::Key_PageDown)) {
+        const int jump = qMax(1, frameCount() / 10);
+        seekFrame(frame + (event->key() == Qt::Key_PageDown ? jump : -jump));
+    } else if (frameCount() > 1 && (event->key() == Qt::Key_BracketLeft || event->key() == Qt::Key_BracketRight)) {
+        playSpeed = qBound(0.125, event->key() == Qt::Key_BracketRight ? playSpeed * 2 : playSpeed / 2, 16.0);
+        if (playing)
+            updatePlaybackRate();        // Frames per tick may change; prefetch follows
+        updateTitle();
+    } else if (frameCount() > 1 && event->key() == Qt::Key_R) {
+        playDirection = -playDirection;
+        if (playing)
+            updatePlaybackRate();        // Ring now wants the frames behind
+        updateTitle();
+    } else {
+        QMainWindow::keyPressEvent(event);
+    }
+}
+
+// ============================
+// Function: mouseMoveEvent / leaveEvent / mouseReleaseEvent
+// Hover box follows the cursor; right or middle button drag pans the view
+// ============================
+void MainWindow::mouseMoveEvent(QMouseEvent *event)
+{
+    hoverPos = event->pos();
+    hoverActive = true;
+
+    if (panning) {
+        QPoint delta = event->pos() - panStart;
 
-        // Prepare message string with coordinates & value
-        QString msg = QString("X = %1°\nY = %2°\nZ = %3")
-                          .arg(xAngle, 0, 'f', 2)  // X angle, 2 decimal places
-                          .arg(yAngle, 0, 'f', 2)  // Y angle, 2 decimal places
-                          .arg(z);                 // Actual Z value
+        view = panStartView.translated(-delta.x() * view.width() / width(),
+                                       -delta.y() * view.height() / height());
+        clampView();
 
-        // Show the message box with cell info
-        QMessageBox::information(this, "Cell Info", msg);
+        viewDirty = true;
+        renderer->widget()->update();
     }
+
+    updateHover();
+}
+
+void MainWindow::leaveEvent(QEvent *event)
+{
+    Q_UNUSED(event);
+    hoverActive = false;
+    hover->hide();
+}
+
+void MainWindow::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::RightButton || event->button() == Qt::MiddleButton)
+        panning = false;
+}
+
+// ============================
+// Function: mousePressEvent
+// Called when user clicks inside the window
+// Left click: shows the clicked cell's info in the hover box (no modal dialog,
+// streaming and repaints keep running)
+// Right / middle button: starts panning
+// ============================
+void MainWindow::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::RightButton || event->button() == Qt::MiddleButton) {
+        panning = true;
+        panStart = event->pos();
+        panStartView = view;
+        return;
+    }
+
+    // Cell through the current view (zoom / pan)
+    hoverPos = event->pos();
+    hoverActive = true;
+    updateHover();
 }
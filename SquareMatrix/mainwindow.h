@@ -4,8 +4,20 @@
 // Qt includes
 #include <QMainWindow>        // Base class for main application windows
 #include <QImage>             // Provides image handling (used for heatmap rendering)
-#include <QVector>            // Dynamic array container (used for storing z-values)
 #include <QMouseEvent>        // Handles mouse input events
+#include "densegrid.h"        // Contiguous row-major grid (used for storing z-values)
+#include "colorlut.h"         // Colour ramp baked into a QRgb lookup table
+#include "heatmapfeed.h"      // Thread-safe inbox for live data (frames / rows / tiles)
+#include <QElapsedTimer>      // Measures time since the last streamed frame
+#include <QTimer>             // Schedules coalesced repaints
+#include "tilepyramid.h"      // Min/max/mean tile pyramid for zoomed-out views
+#include "matrixfile.h"       // Memory-mapped binary matrix files
+#include "gridstats.h"        // Min/max/mean/percentiles, updated incrementally
+#include "heatmaprenderer.h"  // OpenGL or software drawing surface for the visible cells
+#include "cellpicker.h"       // Screen ↔ cell mapping through the current view
+#include "hoveroverlay.h"     // Non-modal cell info next to the cursor
+#include "gridgenerator.h"    // Counter-based, reproducible parallel grid generator
+#include "frameprefetcher.h"  // Background ring of upcoming playback frames
 
 // MainWindow class declaration (inherits from QMainWindow)
 class MainWindow : public QMainWindow
@@ -14,18 +26,62 @@ class MainWindow : public QMainWindow
 
 public:
     // Constructor: initializes the main window
-    explicit MainWindow(QWidget *parent = nullptr);
+    // dataFile given → the grid is loaded from that matrix or CSV file (no dialogs, no random data);
+    // otherwise dataSeed = 0 picks a random seed, any other value reproduces the same grid,
+    // and dataPattern picks what the generated grid looks like
+    explicit MainWindow(quint32 dataSeed = 0, const QString &dataFile = QString(),
+                        GridGenerator::Pattern dataPattern = GridGenerator::Uniform, QWidget *parent = nullptr);
 
     // Destructor: cleans up resources
     ~MainWindow();
 
-protected:
-    // Handles window painting events (called automatically when window needs to be redrawn)
-    void paintEvent(QPaintEvent *event) override;
+    // Replaces the colour ramp with one loaded from a ramp file and re-colours the heatmap
+    bool loadPalette(const QString &path);
+
+    // Maps a binary matrix file and shows it (cells are read from disk only when viewed)
+    bool loadMatrix(const QString &path);
+
+    // Writes the current grid as a binary matrix file
+    bool saveMatrix(const QString &path);
+
+    // Parses a CSV / text matrix (one grid row per line) into the grid
+    bool importCsv(const QString &path);
+
+    // Live data input: producers on any thread push frames/rows/tiles here
+    HeatmapFeed *dataFeed() const { return feed; }
+
+    // Current grid size (for producers that stream rows or tiles)
+    int gridRows() const { return rows; }
+    int gridCols() const { return cols; }
 
+    // Time series playback (matrix files with several frames):
+    // frames per second at 1× speed, and play from the current frame
+    void setPlaybackRate(double fps);
+    void startPlayback();
+
+private slots:
+    // Schedules applyFeedUpdates for the next display refresh
+    void scheduleFrame();
+
+    // Drains the feed and re-renders the view if visible cells changed
+    void applyFeedUpdates();
+
+    // Playback tick: shows the next prefetched frame (or keeps the current one)
+    void advancePlayback();
+
+protected:
     // Handles mouse press events (called when user clicks inside the window)
     void mousePressEvent(QMouseEvent *event) override;
 
+    // Hover info (mouse move / leave), pan (right/middle drag), zoom (wheel),
+    // reset / aggregate / scale / playback keys, resize
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
 private:
     // Number of rows in the data grid
     int rows;
@@ -39,20 +95,142 @@ private:
     // Maximum value in the dataset
     int maxVal;
 
-    // 2D grid storing integer values (z-values for the heatmap)
-    QVector<QVector<int>> zValues;
+    // Real cell value = valueOffset + z × valueStep (0 / 1 unless a float
+    // matrix file was quantised onto the int grid)
+    double valueOffset;
+    double valueStep;
+
+    // How values map onto the palette:
+    // Fixed = minVal..maxVal, Auto = data min..max, Percentile = 1st..99th percentile
+    enum ScaleMode { FixedScale, AutoScale, PercentileScale };
+    ScaleMode scaleMode;
+
+    // Value range currently stretched over the palette (set by applyScaleMode)
+    int scaleLow;
+    int scaleHigh;
+
+    // Statistics of zValues (computed on demand, then kept up to date per changed area)
+    GridStats stats;
+
+    // Seed and pattern for generateData (every cell is a hash of seed, row and column)
+    quint32 seed;
+    GridGenerator::Pattern pattern;
+
+    // Mapped matrix file backing zValues (when the grid was loaded from disk)
+    MatrixFile matrixFile;
+
+    // Playback frames read from matrixFile on a worker thread; declared after
+    // matrixFile so the worker is stopped before the mapping goes away
+    FramePrefetcher prefetcher;
+    QRectF playTarget;                        // where a playback block lands in the window
+
+    // Frame shown (zValues holds it unless playing), playback state and speed
+    int frame;
+    bool playing;
+    bool awaitingFrame;                       // playing: frame not on screen yet (seek / new view)
+    double frameRate;                         // frames per second at 1×
+    double playSpeed;                         // 0.125× … 16×
+    int playDirection;                        // +1 forwards, -1 backwards
+    int playStep;                             // frames advanced per tick (direction × frames per tick)
+    QTimer *playTimer;
+
+    // 2D grid storing integer values (z-values for the heatmap), one contiguous buffer
+    // (own memory when generated, a view over matrixFile when loaded)
+    DenseGrid<int> zValues;
+
+    // Level-of-detail pyramid over zValues (tiles built on a worker thread when zoomed out)
+    TilePyramid pyramid;
+
+    // What a zoomed-out pixel shows: min, max (default, keeps peaks) or mean
+    TilePyramid::Aggregate aggregate;
 
-    // Image object that will store and display the generated heatmap
-    QImage heatmap;
+    // Visible part of the grid in cell coordinates (x = column, y = row),
+    // stretched over the whole window
+    QRectF view;
+
+    // Drawing surface (central widget); gets the visible values, palette and range
+    HeatmapRenderer *renderer;
+
+    // View moved or data changed: visible values must be gathered again before the next paint
+    bool viewDirty;
+
+    // Grid cells the renderer holds one value per cell (zoomed in, not reduced);
+    // empty otherwise. Streamed changes inside it are patched into the renderer
+    QRect shownCells;
+
+    // Maps window positions to cells for hover / click (kept in sync with view)
+    CellPicker picker;
+
+    // Cell info box following the cursor, and where the cursor is (hoverActive = inside window)
+    HoverOverlay *hover;
+    QPoint hoverPos;
+    bool hoverActive;
+
+    // Right/middle button drag state
+    bool panning;
+    QPoint panStart;
+    QRectF panStartView;
+
+    // Colour lookup table given to the renderer (ColorLut::defaultRamp unless a palette is loaded)
+    ColorLut palette;
 
     // Generates random or test data for the heatmap
     void generateData();
 
-    // Converts the data (zValues) into a heatmap image (QImage)
-    void generateHeatmap();
+    // Hands the visible cells (from the grid or a pyramid level) to the renderer
+    void renderView();
+
+    // Window position → cell coordinates through the current view
+    QPointF screenToCell(const QPointF &pos) const;
+
+    // Shows the whole grid again
+    void resetView();
+
+    // Keeps the view inside the grid and no smaller than a few cells
+    void clampView();
+
+    // Gives the picker the current view and window size
+    void syncPicker();
+
+    // Shows / refreshes / hides the hover box for the cell under hoverPos
+    void updateHover();
+
+    // Hover text for one cell (angles + value)
+    QString cellInfo(int i, int j) const;
+
+    // Sets scaleLow / scaleHigh for scaleMode (and the renderer); returns true if they changed
+    bool applyScaleMode();
+
+    // Playback: frames in the file (1 without one), frame index wrapped into range
+    int frameCount() const;
+    int wrapFrame(int index) const;
+
+    // Puts one file frame into zValues (in place for int32, converted otherwise)
+    void loadFrame(int index);
+
+    // Pause / stop for good (new data: the prefetch worker lets go of the file)
+    void stopPlayback();
+    void haltPlayback();
+
+    // Jumps to a frame: paused → full grid, playing → shown once prefetched
+    void seekFrame(int index);
+
+    // Playing: shows a prefetched frame and moves prefetching past it; false if not read yet
+    bool showPlaybackFrame(int index);
+
+    // New producer for the current view (view, window or aggregate changed)
+    void restartPrefetch();
+
+    // Timer interval and frames per tick for frameRate × playSpeed
+    void updatePlaybackRate();
+
+    // Frame number, speed and direction in the window title
+    void updateTitle();
 
-    // Maps a normalized value (0.0–1.0) to a QColor for visualization
-    QColor getColorFromValue(double value);
+    // Streaming: queued updates, frame pacing timer, time of last applied frame
+    HeatmapFeed *feed;
+    QTimer *frameTimer;
+    QElapsedTimer lastFrame;
 };
 
 #endif // MAINWINDOW_H   // End of include guard
@@ -0,0 +1,16 @@
+# Shared code for the UDP transfer tools (FileClient / FileServer).
+# Include from a .pro file with: include(../TransferCommon/TransferCommon.pri)
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/datagramcipher.cpp \
+    $$PWD/transferscheduler.cpp
+
+HEADERS += \
+    $$PWD/datagramcipher.h \
+    $$PWD/transferscheduler.h
+
+# AES-GCM comes from OpenSSL's libcrypto (the same library Qt's TLS backend uses)
+win32: LIBS += -llibcrypto
+else: LIBS += -lcrypto
@@ -0,0 +1,111 @@
+#include "datagramcipher.h"
+#include <QCryptographicHash>
+#include <QPasswordDigestor>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <openssl/evp.h>
+
+namespace {
+const int KeySize = 32;
+const int KdfIterations = 100000;
+const char KdfSalt[] = "Qt-Framework/UDP-transfer/v1";
+}
+
+DatagramCipher::DatagramCipher()
+    : encryptCtx(EVP_CIPHER_CTX_new())
+    , decryptCtx(EVP_CIPHER_CTX_new())
+    , enabled(false)
+    , noncePrefix(QRandomGenerator::system()->generate())
+    , nonceCounter(0)
+{
+}
+
+DatagramCipher::~DatagramCipher()
+{
+    EVP_CIPHER_CTX_free(encryptCtx);
+    EVP_CIPHER_CTX_free(decryptCtx);
+}
+
+void DatagramCipher::setPassphrase(const QString &passphrase)
+{
+    if(passphrase == currentPassphrase && (enabled || passphrase.isEmpty()))
+        return;
+
+    currentPassphrase = passphrase;
+    enabled = !passphrase.isEmpty();
+
+    if(!enabled)
+        return;
+
+    const QByteArray key = QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha256,
+                                                              passphrase.toUtf8(),
+                                                              QByteArray(KdfSalt),
+                                                              KdfIterations, KeySize);
+
+    const unsigned char *k = reinterpret_cast<const unsigned char *>(key.constData());
+
+    EVP_EncryptInit_ex(encryptCtx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr);
+    EVP_CIPHER_CTX_ctrl(encryptCtx, EVP_CTRL_GCM_SET_IVLEN, NonceSize, nullptr);
+    EVP_EncryptInit_ex(encryptCtx, nullptr, nullptr, k, nullptr);
+
+    EVP_DecryptInit_ex(decryptCtx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr);
+    EVP_CIPHER_CTX_ctrl(decryptCtx, EVP_CTRL_GCM_SET_IVLEN, NonceSize, nullptr);
+    EVP_DecryptInit_ex(decryptCtx, nullptr, nullptr, k, nullptr);
+
+    // A → B → A derives A's key again; the counter keeps running, so its
+    // nonces cannot repeat, and a fresh prefix keeps other runs apart
+    noncePrefix = QRandomGenerator::system()->generate();
+}
+
+QByteArray DatagramCipher::seal(const QByteArray &plain)
+{
+    if(!enabled)
+        return plain;
+
+    QByteArray sealed(Overhead + plain.size(), Qt::Uninitialized);
+    unsigned char *out = reinterpret_cast<unsigned char *>(sealed.data());
+
+    qToBigEndian(noncePrefix, out);
+    qToBigEndian(nonceCounter++, out + 4);
+
+    int len = 0;
+    EVP_EncryptInit_ex(encryptCtx, nullptr, nullptr, nullptr, out);
+    EVP_EncryptUpdate(encryptCtx, out + NonceSize, &len,
+                      reinterpret_cast<const unsigned char *>(plain.constData()), plain.size());
+    EVP_EncryptFinal_ex(encryptCtx, out + NonceSize + len, &len);
+    EVP_CIPHER_CTX_ctrl(encryptCtx, EVP_CTRL_GCM_GET_TAG, TagSize, out + NonceSize + plain.size());
+
+    return sealed;
+}
+
+bool DatagramCipher::open(const QByteArray &sealed, QByteArray *plain)
+{
+    if(!enabled)
+    {
+        *plain = sealed;
+        return true;
+    }
+
+    const int payloadSize = sealed.size() - Overhead;
+    if(payloadSize < 0)
+        return false;
+
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(sealed.constData());
+    QByteArray tag = sealed.right(TagSize);
+
+    plain->resize(payloadSize);
+    unsigned char *out = reinterpret_cast<unsigned char *>(plain->data());
+
+    int len = 0;
+    EVP_DecryptInit_ex(decryptCtx, nullptr, nullptr, nullptr, in);
+    EVP_DecryptUpdate(decryptCtx, out, &len, in + NonceSize, payloadSize);
+    EVP_CIPHER_CTX_ctrl(decryptCtx, EVP_CTRL_GCM_SET_TAG, TagSize, tag.data());
+
+    if(EVP_DecryptFinal_ex(decryptCtx, out + len, &len) <= 0)
+    {
+        plain->clear();
+        return false;
+    }
+
+    return true;
+}
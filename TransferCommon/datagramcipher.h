@@ -0,0 +1,45 @@
+#ifndef DATAGRAMCIPHER_H
+#define DATAGRAMCIPHER_H
+
+#include <QByteArray>
+#include <QString>
+
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
+// AES-256-GCM sealing of single UDP datagrams.
+// Wire format: nonce(12) | ciphertext | tag(16).
+// OpenSSL picks AES-NI / PCLMULQDQ at runtime, and the key schedule is set up
+// once per passphrase, so each datagram only costs an IV reset + one pass.
+class DatagramCipher
+{
+public:
+    enum { NonceSize = 12, TagSize = 16, Overhead = NonceSize + TagSize };
+
+    DatagramCipher();
+    ~DatagramCipher();
+
+    // Derives the key (PBKDF2-SHA256). An empty passphrase disables encryption.
+    // The salt is fixed, so switching back to a passphrase gives the same key
+    // again: nonces never restart (see noncePrefix / nonceCounter)
+    void setPassphrase(const QString &passphrase);
+    bool isEnabled() const { return enabled; }
+
+    QByteArray seal(const QByteArray &plain);
+
+    // Returns false if the datagram is malformed or fails authentication
+    bool open(const QByteArray &sealed, QByteArray *plain);
+
+private:
+    Q_DISABLE_COPY(DatagramCipher)
+
+    EVP_CIPHER_CTX *encryptCtx;
+    EVP_CIPHER_CTX *decryptCtx;
+
+    QString currentPassphrase;
+    bool enabled;
+
+    quint32 noncePrefix;    // random, drawn again on every key change
+    quint64 nonceCounter;   // never reset: unique nonces even when a key comes back
+};
+
+#endif // DATAGRAMCIPHER_H
@@ -0,0 +1,13 @@
+QT += testlib
+QT -= gui
+
+CONFIG += qt console warn_on depend_includepath testcase c++17
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = tst_transfercommon
+
+SOURCES += \
+    tst_transfercommon.cpp
+
+include(../TransferCommon.pri)
@@ -0,0 +1,120 @@
+#include <QtTest>
+#include <QSet>
+#include "datagramcipher.h"
+#include "transferscheduler.h"
+
+class TransferCommonTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sealOpenRoundTrip();
+    void noncesNeverRepeat();
+    void defaultRateKeepsExplicitPeerRates();
+    void sealOpenThroughput_data();
+    void sealOpenThroughput();
+};
+
+void TransferCommonTest::sealOpenRoundTrip()
+{
+    DatagramCipher sender;
+    DatagramCipher receiver;
+    sender.setPassphrase("secret");
+    receiver.setPassphrase("secret");
+
+    const QByteArray plain("DATA chunk");
+    const QByteArray sealed = sender.seal(plain);
+    QCOMPARE(sealed.size(), plain.size() + int(DatagramCipher::Overhead));
+
+    QByteArray opened;
+    QVERIFY(receiver.open(sealed, &opened));
+    QCOMPARE(opened, plain);
+
+    // Tampered datagrams fail authentication
+    QByteArray tampered = sealed;
+    tampered[DatagramCipher::NonceSize] = char(tampered.at(DatagramCipher::NonceSize) ^ 1);
+    QVERIFY(!receiver.open(tampered, &opened));
+}
+
+void TransferCommonTest::noncesNeverRepeat()
+{
+    // FileClient sets the passphrase before every send, so a key can come
+    // back (A → B → A, A → "" → A) and must not restart its nonces
+    DatagramCipher cipher;
+    QSet<QByteArray> nonces;
+    const QStringList passphrases = { "A", "A", "B", "A", "", "A" };
+
+    for(const QString &passphrase : passphrases)
+    {
+        cipher.setPassphrase(passphrase);
+        if(!cipher.isEnabled())
+            continue;
+
+        for(int i = 0; i < 100; ++i)
+        {
+            const QByteArray nonce = cipher.seal("x").left(DatagramCipher::NonceSize);
+            QVERIFY2(!nonces.contains(nonce), "nonce repeated");
+            nonces.insert(nonce);
+        }
+    }
+
+    QCOMPARE(nonces.size(), 500);
+}
+
+void TransferCommonTest::defaultRateKeepsExplicitPeerRates()
+{
+    TransferScheduler scheduler;
+    scheduler.addTransfer(1, "capped");
+    scheduler.addTransfer(2, "other");
+    scheduler.setPeerRate("capped", 1000);
+    scheduler.setDefaultPeerRate(0);
+
+    // Buckets start empty: the capped peer has no tokens yet, the other one is unlimited
+    scheduler.setActive(1, true);
+    QCOMPARE(scheduler.pick(1000), -1);
+
+    scheduler.setActive(2, true);
+    QCOMPARE(scheduler.pick(1000), 2);
+}
+
+void TransferCommonTest::sealOpenThroughput_data()
+{
+    QTest::addColumn<QString>("passphrase");
+
+    QTest::newRow("plaintext") << QString();
+    QTest::newRow("aes-256-gcm") << QString("secret");
+}
+
+void TransferCommonTest::sealOpenThroughput()
+{
+    // Every datagram of a transfer goes through seal() on the client and
+    // open() on the server. One iteration moves 1 MiB as 1024-byte chunks
+    // (FileClient's chunk size), so ms per iteration is ms per MiB; the
+    // plaintext row is the cost without a passphrase
+    QFETCH(QString, passphrase);
+
+    DatagramCipher sender;
+    DatagramCipher receiver;
+    sender.setPassphrase(passphrase);
+    receiver.setPassphrase(passphrase);
+
+    const QByteArray chunk(1024, 'x');
+    QByteArray opened;
+    int failures = 0;
+
+    QBENCHMARK
+    {
+        for(int i = 0; i < 1024; ++i)
+        {
+            if(!receiver.open(sender.seal(chunk), &opened))
+                ++failures;
+        }
+    }
+
+    QCOMPARE(failures, 0);
+    QCOMPARE(opened, chunk);
+}
+
+QTEST_APPLESS_MAIN(TransferCommonTest)
+
+#include "tst_transfercommon.moc"
@@ -0,0 +1,247 @@
+#include "transferscheduler.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+// Buckets hold at most this much time worth of tokens (burst size)
+const double BurstSeconds = 0.05;
+const qint64 MinBurstBytes = 64 * 1024;
+
+// Share multiplier per priority level
+const double PriorityFactor[] = { 16.0, 4.0, 1.0 };
+}
+
+void TransferScheduler::Bucket::setRate(qint64 bytesPerSecond)
+{
+    rate = qMax<qint64>(0, bytesPerSecond);
+    tokens = qMin(tokens, double(qMax<qint64>(MinBurstBytes, qint64(rate * BurstSeconds))));
+}
+
+void TransferScheduler::Bucket::refill(double seconds)
+{
+    if(rate == 0)
+        return;
+
+    const double burst = qMax<double>(MinBurstBytes, rate * BurstSeconds);
+    tokens = qMin(burst, tokens + rate * seconds);
+}
+
+double TransferScheduler::Bucket::secondsUntil(qint64 bytes) const
+{
+    if(allows(bytes))
+        return 0.0;
+
+    return (bytes - tokens) / rate;
+}
+
+TransferScheduler::TransferScheduler()
+    : defaultPeerRate(0)
+    , lastRefillNs(0)
+{
+    clock.start();
+}
+
+void TransferScheduler::setGlobalRate(qint64 bytesPerSecond)
+{
+    refill();
+    global.setRate(bytesPerSecond);
+}
+
+void TransferScheduler::setDefaultPeerRate(qint64 bytesPerSecond)
+{
+    refill();
+    defaultPeerRate = bytesPerSecond;
+
+    for(auto it = peers.begin(); it != peers.end(); ++it)
+    {
+        if(!it->explicitRate)
+            it->setRate(bytesPerSecond);
+    }
+}
+
+void TransferScheduler::setPeerRate(const QString &peer, qint64 bytesPerSecond)
+{
+    refill();
+
+    Bucket &bucket = peerBucket(peer);
+    bucket.setRate(bytesPerSecond);
+    bucket.explicitRate = true;
+}
+
+void TransferScheduler::addTransfer(int id, const QString &peer, Priority priority, int weight)
+{
+    Transfer transfer;
+    transfer.peer = peer;
+    transfer.priority = priority;
+    transfer.weight = qMax(1, weight);
+    transfer.active = false;
+    transfer.virtualTime = 0.0;
+
+    transfers.insert(id, transfer);
+    peerBucket(peer);
+}
+
+void TransferScheduler::removeTransfer(int id)
+{
+    transfers.remove(id);
+}
+
+void TransferScheduler::setPriority(int id, Priority priority)
+{
+    auto it = transfers.find(id);
+    if(it != transfers.end())
+        it->priority = priority;
+}
+
+void TransferScheduler::setWeight(int id, int weight)
+{
+    auto it = transfers.find(id);
+    if(it != transfers.end())
+        it->weight = qMax(1, weight);
+}
+
+void TransferScheduler::setTransferRate(int id, qint64 bytesPerSecond)
+{
+    refill();
+
+    auto it = transfers.find(id);
+    if(it != transfers.end())
+        it->bucket.setRate(bytesPerSecond);
+}
+
+void TransferScheduler::setActive(int id, bool active)
+{
+    auto it = transfers.find(id);
+    if(it == transfers.end() || it->active == active)
+        return;
+
+    // A transfer waking up joins at the current virtual time, so it cannot
+    // claim the bandwidth it "missed" while idle
+    if(active)
+        it->virtualTime = qMax(it->virtualTime, minActiveVirtualTime());
+
+    it->active = active;
+}
+
+bool TransferScheduler::hasActive() const
+{
+    for(const Transfer &transfer : transfers)
+    {
+        if(transfer.active)
+            return true;
+    }
+
+    return false;
+}
+
+int TransferScheduler::pick(qint64 packetBytes)
+{
+    refill();
+
+    if(!global.allows(packetBytes))
+        return -1;
+
+    int bestId = -1;
+    double bestTime = std::numeric_limits<double>::max();
+
+    for(auto it = transfers.constBegin(); it != transfers.constEnd(); ++it)
+    {
+        const Transfer &transfer = it.value();
+
+        if(!transfer.active || !transfer.bucket.allows(packetBytes))
+            continue;
+
+        if(!peers[transfer.peer].allows(packetBytes))
+            continue;
+
+        if(transfer.virtualTime < bestTime)
+        {
+            bestTime = transfer.virtualTime;
+            bestId = it.key();
+        }
+    }
+
+    if(bestId < 0)
+        return -1;
+
+    Transfer &chosen = transfers[bestId];
+    chosen.virtualTime += packetBytes / effectiveWeight(chosen);
+    chosen.bucket.charge(packetBytes);
+    peers[chosen.peer].charge(packetBytes);
+    global.charge(packetBytes);
+
+    return bestId;
+}
+
+int TransferScheduler::msUntilReady(qint64 packetBytes)
+{
+    refill();
+
+    double wait = std::numeric_limits<double>::max();
+
+    for(const Transfer &transfer : transfers)
+    {
+        if(!transfer.active)
+            continue;
+
+        double t = qMax(transfer.bucket.secondsUntil(packetBytes),
+                        peers[transfer.peer].secondsUntil(packetBytes));
+        wait = qMin(wait, t);
+    }
+
+    if(wait == std::numeric_limits<double>::max())
+        return -1;
+
+    wait = qMax(wait, global.secondsUntil(packetBytes));
+    return int(std::ceil(wait * 1000.0));
+}
+
+void TransferScheduler::refill()
+{
+    const qint64 now = clock.nsecsElapsed();
+    const double seconds = (now - lastRefillNs) / 1e9;
+    lastRefillNs = now;
+
+    global.refill(seconds);
+
+    for(auto it = peers.begin(); it != peers.end(); ++it)
+        it->refill(seconds);
+
+    for(auto it = transfers.begin(); it != transfers.end(); ++it)
+        it->bucket.refill(seconds);
+}
+
+TransferScheduler::Bucket &TransferScheduler::peerBucket(const QString &peer)
+{
+    auto it = peers.find(peer);
+
+    if(it == peers.end())
+    {
+        it = peers.insert(peer, Bucket());
+        it->setRate(defaultPeerRate);
+    }
+
+    return *it;
+}
+
+double TransferScheduler::effectiveWeight(const Transfer &transfer) const
+{
+    return transfer.weight * PriorityFactor[transfer.priority];
+}
+
+double TransferScheduler::minActiveVirtualTime() const
+{
+    double minTime = 0.0;
+    bool found = false;
+
+    for(const Transfer &transfer : transfers)
+    {
+        if(transfer.active && (!found || transfer.virtualTime < minTime))
+        {
+            minTime = transfer.virtualTime;
+            found = true;
+        }
+    }
+
+    return minTime;
+}
@@ -0,0 +1,90 @@
+#ifndef TRANSFERSCHEDULER_H
+#define TRANSFERSCHEDULER_H
+
+#include <QHash>
+#include <QString>
+#include <QElapsedTimer>
+
+// Decides which of several concurrent transfers may put the next packet on
+// the wire.
+//
+// Rate caps form a small hierarchy of token buckets: global -> per peer ->
+// per transfer; a packet goes out only if every level has tokens. Among the
+// transfers that pass, the one with the smallest virtual time (bytes sent /
+// effective weight) wins, so bandwidth is shared in proportion to
+// weight x priority factor. Urgent transfers get most of the link, but a
+// background transfer still advances and is never starved.
+//
+// Every setter may be called while transfers are running.
+class TransferScheduler
+{
+public:
+    enum Priority { Urgent, Normal, Background };
+
+    TransferScheduler();
+
+    // Rates are bytes per second, 0 means unlimited. The default applies to
+    // every peer without a rate of its own from setPeerRate
+    void setGlobalRate(qint64 bytesPerSecond);
+    void setDefaultPeerRate(qint64 bytesPerSecond);
+    void setPeerRate(const QString &peer, qint64 bytesPerSecond);
+
+    void addTransfer(int id, const QString &peer, Priority priority = Normal, int weight = 1);
+    void removeTransfer(int id);
+
+    void setPriority(int id, Priority priority);
+    void setWeight(int id, int weight);
+    void setTransferRate(int id, qint64 bytesPerSecond);
+
+    // Only active transfers (something to send) compete for bandwidth
+    void setActive(int id, bool active);
+    bool hasActive() const;
+
+    // Picks the transfer that may send packetBytes now and charges it,
+    // or returns -1 when every active transfer is throttled / none is active
+    int pick(qint64 packetBytes);
+
+    // Milliseconds until some active transfer could send packetBytes
+    int msUntilReady(qint64 packetBytes);
+
+private:
+    struct Bucket
+    {
+        Bucket() : rate(0), tokens(0), explicitRate(false) {}
+
+        void setRate(qint64 bytesPerSecond);
+        void refill(double seconds);
+        bool allows(qint64 bytes) const { return rate == 0 || tokens >= bytes; }
+        void charge(qint64 bytes) { if(rate != 0) tokens -= bytes; }
+        double secondsUntil(qint64 bytes) const;
+
+        qint64 rate;
+        double tokens;
+        bool explicitRate;      // peer buckets: rate from setPeerRate, not the default
+    };
+
+    struct Transfer
+    {
+        QString peer;
+        Priority priority;
+        int weight;
+        bool active;
+        double virtualTime;
+        Bucket bucket;
+    };
+
+    void refill();
+    Bucket &peerBucket(const QString &peer);
+    double effectiveWeight(const Transfer &transfer) const;
+    double minActiveVirtualTime() const;
+
+    Bucket global;
+    qint64 defaultPeerRate;
+    QHash<QString, Bucket> peers;
+    QHash<int, Transfer> transfers;
+
+    QElapsedTimer clock;
+    qint64 lastRefillNs;
+};
+
+#endif // TRANSFERSCHEDULER_H